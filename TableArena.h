@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//bump allocator over a caller-supplied buffer: a static array, internal RAM, or PSRAM from ps_malloc()
+//to keep large tables out of the internal heap. Tables built in an arena take all their buffers from
+//it and free nothing; reset() (or rewind() to an earlier getUsed()) drops them all at once, so screens
+//can be built and torn down repeatedly without fragmenting the heap. Destroy the tables first.
+class TableArena {
+public:
+  TableArena(void *buffer, size_t size) : buffer(static_cast<uint8_t *>(buffer)), size(size), used(0) {}
+
+  //4 byte aligned, nullptr when the arena is full
+  void *allocate(size_t bytes) {
+    size_t start = (used + 3) & ~(size_t)3;
+    if (buffer == nullptr || start > size || bytes > size - start)
+      return nullptr;
+
+    used = start + bytes;
+    return buffer + start;
+  }
+
+  void reset() { used = 0; }
+  void rewind(size_t used) {
+    if (used < this->used)
+      this->used = used;
+  }
+
+  size_t getUsed() const { return used; }
+  size_t getSize() const { return size; }
+
+private:
+  uint8_t *buffer;
+  size_t size;
+  size_t used;
+};
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <SPI.h>
+#include <TFT_eSPI.h>
+
+#include "TableLayout.h"
+#include "TableRender.h"
+
+//TableStack with the whole layout fixed at compile time: column widths, row heights and padding are
+//template arguments, offsets and centers are constexpr tables in flash, there is no generate() and
+//only the cell colors take up RAM. Drawing, dirty tracking and hit testing come from TableRender; texts
+//can be drawn but aren't kept, so updateCellText() and updateCells() don't compile.
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop = 0, uint16_t PaddingBottom = 0, uint16_t PaddingLeft = 0, uint16_t PaddingRight = 0>
+class TableFlash : public TableRender<TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes,
+    PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>> {
+public:
+    TableFlash(TFT_eSPI* tft, uint16_t outlineColor, uint16_t fillColor);
+
+    void drawScanlines();
+
+    void setCellFillColor(uint8_t row, uint8_t column, uint16_t color);
+    void setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color);
+    uint16_t getCellFillColor(uint8_t row, uint8_t column) const;
+    uint16_t getCellOutlineColor(uint8_t row, uint8_t column) const;
+
+    uint16_t getX() const;
+    uint16_t getY() const;
+    uint16_t getWidth() const;
+    uint16_t getHeight() const;
+    uint8_t getRows() const;
+    uint8_t getColumns() const;
+
+    ~TableFlash();
+
+private:
+    typedef TableLayout<X + PaddingLeft, Width - PaddingLeft - PaddingRight, ColumnSizes> ColumnLayout;
+    typedef TableLayout<Y + PaddingTop, Height - PaddingTop - PaddingBottom, RowSizes> RowLayout;
+
+    static constexpr uint8_t rows = RowSizes::count;
+    static constexpr uint8_t columns = ColumnSizes::count;
+
+    uint16_t outlineColor, fillColor;
+    uint16_t cellFillColors[rows][columns];
+    uint16_t cellOutlineColors[rows][columns];
+
+    // one bit per cell, row-major; set by the color setters, consumed by flush() and step()
+    uint8_t dirtyCells[(rows * columns + 7) / 8];
+
+    // storage TableRender draws from, the layout is in flash and there are no cell texts
+    friend class TableRender<TableFlash>;
+    static constexpr bool storesTexts = false;
+    TableAxis columnAxis() const { return TableAxis{ColumnLayout::offsets, ColumnLayout::sizes}; }
+    TableAxis rowAxis() const { return TableAxis{RowLayout::offsets, RowLayout::sizes}; }
+    TableCellText* storedTexts() { return nullptr; }
+    TableCellText* acquireTexts() { return nullptr; }
+};
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::TableFlash(TFT_eSPI* tft, uint16_t outlineColor, uint16_t fillColor) :
+    TableRender<TableFlash>(tft), outlineColor(outlineColor), fillColor(fillColor),
+    dirtyCells{0} {
+
+    for (auto i = 0; i < rows; i++) {
+        for (auto j = 0; j < columns; j++) {
+            cellFillColors[i][j] = fillColor;
+            cellOutlineColors[i][j] = outlineColor;
+        }
+    }
+}
+
+//the scanlines are built on the stack, as wide as the table
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+void TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::drawScanlines() {
+    //one scanline for the top/bottom outline of a row, one for the pixel rows in between
+    uint16_t edgeLine[Width - PaddingLeft - PaddingRight];
+    uint16_t innerLine[Width - PaddingLeft - PaddingRight];
+    this->pushScanlines(edgeLine, innerLine);
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+void TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::setCellFillColor(uint8_t row, uint8_t column, uint16_t color) {
+    if (cellFillColors[row][column] == color)
+        return;
+
+    cellFillColors[row][column] = color;
+    this->markDirty(row, column);
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+void TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color) {
+    if (cellOutlineColors[row][column] == color)
+        return;
+
+    cellOutlineColors[row][column] = color;
+    this->markDirty(row, column);
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+uint16_t TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::getCellFillColor(uint8_t row, uint8_t column) const {
+    return cellFillColors[row][column];
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+uint16_t TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::getCellOutlineColor(uint8_t row, uint8_t column) const {
+    return cellOutlineColors[row][column];
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+uint16_t TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::getX() const {
+    return X + PaddingLeft;
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+uint16_t TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::getY() const {
+    return Y + PaddingTop;
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+uint8_t TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::getRows() const {
+    return rows;
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+uint8_t TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::getColumns() const {
+    return columns;
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+uint16_t TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::getWidth() const {
+    return ColumnLayout::offsets[columns] - ColumnLayout::offsets[0];
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+uint16_t TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::getHeight() const {
+    return RowLayout::offsets[rows] - RowLayout::offsets[0];
+}
+
+template <uint16_t X, uint16_t Y, uint16_t Width, uint16_t Height, class ColumnSizes, class RowSizes,
+    uint16_t PaddingTop, uint16_t PaddingBottom, uint16_t PaddingLeft, uint16_t PaddingRight>
+TableFlash<X, Y, Width, Height, ColumnSizes, RowSizes, PaddingTop, PaddingBottom, PaddingLeft, PaddingRight>::~TableFlash() {}
\ No newline at end of file
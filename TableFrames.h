@@ -0,0 +1,298 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "TableText.h"
+
+//compact binary cell updates for tables driven by a host over UART or similar, independent of
+//TFT_eSPI so both ends also build on a desktop. All numbers are little endian.
+//
+//frame:  0xA5 | payload length (2) | sequence number (2) | payload | checksum (1)
+//record: cell index (2, row * columns + column) | type (1) | fields of the type below
+//
+//the checksum is the low byte of the sum of the sequence number and payload bytes
+
+#define TABLE_FRAME_SYNC 0xA5
+#define TABLE_FRAME_HEADER_SIZE 5
+
+//longer payloads are taken for line noise, which also bounds how long a corrupt length can stall decoding
+#ifndef TABLE_FRAME_MAX_PAYLOAD
+#define TABLE_FRAME_MAX_PAYLOAD 1024
+#endif
+
+enum TableFrameType : uint8_t {
+  TABLE_FRAME_FILL,    //color (2)
+  TABLE_FRAME_OUTLINE, //color (2)
+  TABLE_FRAME_TEXT,    //text color (2), text including its terminating 0
+  TABLE_FRAME_INTEGER, //text color (2), int32 (4)
+  TABLE_FRAME_FLOAT    //text color (2), IEEE 754 float (4), decimals (1)
+};
+
+//builds frames into a caller supplied buffer, for hosts and replay tools; every call returns false,
+//leaving the frame as it was, when the record doesn't fit
+class TableFrameWriter {
+public:
+  TableFrameWriter(uint8_t *buffer, size_t size) : buffer(buffer), size(size), length(0) {}
+
+  void begin(uint16_t sequence) {
+    buffer[0] = TABLE_FRAME_SYNC;
+    buffer[3] = sequence;
+    buffer[4] = sequence >> 8;
+    length = TABLE_FRAME_HEADER_SIZE;
+  }
+
+  bool fill(uint16_t cell, uint16_t color) { return record(cell, TABLE_FRAME_FILL, color, nullptr, 0); }
+  bool outline(uint16_t cell, uint16_t color) { return record(cell, TABLE_FRAME_OUTLINE, color, nullptr, 0); }
+  bool text(uint16_t cell, uint16_t color, const char *text) {
+    return record(cell, TABLE_FRAME_TEXT, color, reinterpret_cast<const uint8_t *>(text), strlen(text) + 1);
+  }
+  bool integer(uint16_t cell, uint16_t color, int32_t value) {
+    uint8_t bytes[4] = {(uint8_t)value, (uint8_t)(value >> 8), (uint8_t)(value >> 16), (uint8_t)(value >> 24)};
+    return record(cell, TABLE_FRAME_INTEGER, color, bytes, sizeof(bytes));
+  }
+  bool real(uint16_t cell, uint16_t color, float value, uint8_t decimals) {
+    uint8_t bytes[5];
+    memcpy(bytes, &value, 4);
+    bytes[4] = decimals;
+    return record(cell, TABLE_FRAME_FLOAT, color, bytes, sizeof(bytes));
+  }
+
+  //completes the frame, returns its size in bytes (0 when even the checksum doesn't fit)
+  size_t end() {
+    if (length + 1 > size)
+      return 0;
+
+    uint16_t payload = length - TABLE_FRAME_HEADER_SIZE;
+    buffer[1] = payload;
+    buffer[2] = payload >> 8;
+
+    uint8_t checksum = 0;
+    for (size_t i = 3; i < length; i++)
+      checksum += buffer[i];
+    buffer[length] = checksum;
+    return length + 1;
+  }
+
+private:
+  uint8_t *buffer;
+  size_t size;
+  size_t length;
+
+  bool record(uint16_t cell, uint8_t type, uint16_t color, const uint8_t *fields, size_t count) {
+    //one byte stays free for the checksum
+    if (length + 5 + count + 1 > size || length + 5 + count - TABLE_FRAME_HEADER_SIZE > TABLE_FRAME_MAX_PAYLOAD)
+      return false;
+
+    auto record = buffer + length;
+    record[0] = cell;
+    record[1] = cell >> 8;
+    record[2] = type;
+    record[3] = color;
+    record[4] = color >> 8;
+    if (count > 0)
+      memcpy(record + 5, fields, count);
+    length += 5 + count;
+    return true;
+  }
+};
+
+//applies frames straight from the receive buffer: texts are used where they lie, numbers are printed
+//into a per-decoder batch. Colors go through the table's setters (which only mark changed cells
+//dirty), then each frame is applied with one applyCells(), which keeps only the last update of each
+//cell, skips unchanged ones and repaints a restyled cell once. Frames whose sequence number isn't
+//newer than the last applied one are dropped as stale.
+template <class Table, uint16_t MaxUpdates = 32>
+class TableFrameDecoder {
+public:
+  TableFrameDecoder(Table *table) : table(table), sequence(0), started(false),
+    frames(0), updates(0), stale(0), lost(0), errors(0) {}
+
+  //decodes and applies every complete frame in data, returns the bytes consumed. Keep the rest,
+  //append what arrives next and call again. Bytes that can't start a frame are skipped.
+  size_t decode(const uint8_t *data, size_t length);
+
+  //restarts sequence numbering, e.g. after the host reconnected
+  void reset() { started = false; }
+
+  uint32_t getFrames() const { return frames; }
+  //records applied, superseded ones included
+  uint32_t getUpdates() const { return updates; }
+  uint32_t getStale() const { return stale; }
+  //frames missing between the sequence numbers of applied ones
+  uint32_t getLost() const { return lost; }
+  //checksum failures and malformed records
+  uint32_t getErrors() const { return errors; }
+
+private:
+  Table *table;
+
+  uint16_t sequence;
+  bool started;
+
+  uint32_t frames;
+  uint32_t updates;
+  uint32_t stale;
+  uint32_t lost;
+  uint32_t errors;
+
+  TableCellUpdate batch[MaxUpdates];
+  char numbers[MaxUpdates][TABLE_CELL_TEXT_SIZE];
+  uint16_t batchCount;
+
+  void apply(const uint8_t *payload, uint16_t length);
+  void push(uint8_t row, uint8_t column, const char *text, uint16_t color);
+  void commit();
+
+  static uint16_t read16(const uint8_t *bytes) { return bytes[0] | bytes[1] << 8; }
+  static uint32_t read32(const uint8_t *bytes) {
+    return bytes[0] | bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+  }
+};
+
+template <class Table, uint16_t MaxUpdates>
+size_t TableFrameDecoder<Table, MaxUpdates>::decode(const uint8_t *data, size_t length) {
+  size_t position = 0;
+
+  while (position < length) {
+    if (data[position] != TABLE_FRAME_SYNC) {
+      position++;
+      continue;
+    }
+
+    if (length - position < TABLE_FRAME_HEADER_SIZE + 1)
+      break;
+
+    auto frame = data + position;
+    uint16_t payload = read16(frame + 1);
+    if (payload > TABLE_FRAME_MAX_PAYLOAD) {
+      errors++;
+      position++;
+      continue;
+    }
+    if (length - position < TABLE_FRAME_HEADER_SIZE + payload + 1u)
+      break;
+
+    uint8_t checksum = 0;
+    for (uint32_t i = 3; i < TABLE_FRAME_HEADER_SIZE + (uint32_t)payload; i++)
+      checksum += frame[i];
+    if (checksum != frame[TABLE_FRAME_HEADER_SIZE + payload]) {
+      //not a frame after all, look for the next sync byte
+      errors++;
+      position++;
+      continue;
+    }
+
+    position += TABLE_FRAME_HEADER_SIZE + payload + 1;
+
+    uint16_t number = read16(frame + 3);
+    int16_t ahead = number - sequence;
+    if (started && ahead <= 0) {
+      stale++;
+      continue;
+    }
+    if (started)
+      lost += ahead - 1;
+    sequence = number;
+    started = true;
+
+    apply(frame + TABLE_FRAME_HEADER_SIZE, payload);
+    frames++;
+  }
+
+  return position;
+}
+
+template <class Table, uint16_t MaxUpdates>
+void TableFrameDecoder<Table, MaxUpdates>::apply(const uint8_t *payload, uint16_t length) {
+  uint16_t cells = table->getRows() * table->getColumns();
+  batchCount = 0;
+
+  uint16_t position = 0;
+  while (position < length) {
+    if (length - position < 5) {
+      errors++;
+      break;
+    }
+
+    auto record = payload + position;
+    uint16_t cell = read16(record);
+    uint8_t type = record[2];
+    uint16_t color = read16(record + 3);
+    auto fields = record + 5;
+    uint16_t left = length - position - 5;
+
+    uint16_t size;
+    switch (type) {
+    case TABLE_FRAME_FILL:
+    case TABLE_FRAME_OUTLINE:
+      size = 0;
+      break;
+    case TABLE_FRAME_TEXT: {
+      auto end = static_cast<const uint8_t *>(memchr(fields, 0, left));
+      size = end != nullptr ? end - fields + 1 : left + 1;
+      break;
+    }
+    case TABLE_FRAME_INTEGER:
+      size = 4;
+      break;
+    case TABLE_FRAME_FLOAT:
+      size = 5;
+      break;
+    default:
+      size = left + 1;
+      break;
+    }
+
+    //the rest of the frame can't be trusted either
+    if (size > left || cell >= cells) {
+      errors++;
+      break;
+    }
+    position += 5 + size;
+    updates++;
+
+    uint8_t row = cell / table->getColumns();
+    uint8_t column = cell % table->getColumns();
+
+    switch (type) {
+    case TABLE_FRAME_FILL:
+      table->setCellFillColor(row, column, color);
+      break;
+    case TABLE_FRAME_OUTLINE:
+      table->setCellOutlineColor(row, column, color);
+      break;
+    case TABLE_FRAME_TEXT:
+      push(row, column, reinterpret_cast<const char *>(fields), color);
+      break;
+    case TABLE_FRAME_INTEGER:
+      tableFormatInteger(numbers[batchCount], TABLE_CELL_TEXT_SIZE, (int32_t)read32(fields));
+      push(row, column, numbers[batchCount], color);
+      break;
+    case TABLE_FRAME_FLOAT: {
+      float value;
+      uint32_t bits = read32(fields);
+      memcpy(&value, &bits, sizeof(value));
+      tableFormatFloat(numbers[batchCount], TABLE_CELL_TEXT_SIZE, value, fields[4]);
+      push(row, column, numbers[batchCount], color);
+      break;
+    }
+    }
+  }
+
+  commit();
+}
+
+template <class Table, uint16_t MaxUpdates>
+void TableFrameDecoder<Table, MaxUpdates>::push(uint8_t row, uint8_t column, const char *text, uint16_t color) {
+  batch[batchCount++] = {row, column, text, color};
+  if (batchCount == MaxUpdates)
+    commit();
+}
+
+template <class Table, uint16_t MaxUpdates>
+void TableFrameDecoder<Table, MaxUpdates>::commit() {
+  table->applyCells(batch, batchCount);
+  batchCount = 0;
+}
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <SPI.h>
+#include <TFT_eSPI.h>
+#include <string.h>
+
+//longest character set a cache takes
+#ifndef TABLE_GLYPHS_SIZE
+#define TABLE_GLYPHS_SIZE 24
+#endif
+
+//pre-rasterized glyphs for cells showing numbers: the given characters (digits, sign, decimal point,
+//units) are drawn once per (text color, background) pair into RGB565 blocks, then a text made only of
+//them is written as one block push per glyph, and with the previous text known only the positions
+//whose character changed are pushed. Built-in fonts (setTextFont()/setTextSize()) and MC_DATUM only,
+//with a smooth or free font loaded draw() declines; measured with the font active on the first draw,
+//call clear() after changing it.
+class TableGlyphCache {
+public:
+  //up to TABLE_GLYPHS_SIZE characters; maxPairs color pairs are kept, the oldest is replaced beyond that
+  TableGlyphCache(TFT_eSPI *tft, const char *characters = "0123456789-+. ", uint8_t maxPairs = 2);
+  ~TableGlyphCache();
+
+  //true when every character of text is cached
+  bool covers(const char *text) const;
+
+  //draws text centered on x, y like drawString() with the text padded to the previous width. previous
+  //is the text an earlier draw() put there in the same colors, its unchanged glyphs are skipped
+  //(nullptr repaints all). width holds the previous text's width and receives the new one, pixels the
+  //number of pixels written. Call between startWrite() and endWrite(). False, with nothing drawn,
+  //when the text or font is not supported or the glyphs can't be rasterized.
+  bool draw(int32_t x, int32_t y, const char *text, const char *previous, uint16_t color, uint16_t background,
+    uint16_t &width, uint32_t &pixels);
+
+  //drops every rasterized glyph and the font's measurements
+  void clear();
+
+  //RAM held by the rasterized glyphs
+  uint32_t getBytes() const;
+
+private:
+  struct Pair {
+    uint16_t color;
+    uint16_t background;
+    uint16_t *pixels;
+  };
+
+  TFT_eSPI *tft;
+
+  char characters[TABLE_GLYPHS_SIZE + 1];
+  uint16_t widths[TABLE_GLYPHS_SIZE];
+  //start of each glyph's block within a pair's pixels
+  uint32_t offsets[TABLE_GLYPHS_SIZE];
+  uint16_t height;
+  uint32_t pairSize;
+
+  Pair *pairs;
+  uint8_t maxPairs;
+  uint8_t pairCount;
+  //slot replaced next once all are taken
+  uint8_t nextPair;
+
+  bool isBuiltinFont() const;
+  int8_t indexOf(char character) const;
+  uint16_t widthOf(const char *text) const;
+  bool measure();
+  const uint16_t *pixelsOf(uint16_t color, uint16_t background);
+  bool rasterize(Pair &pair);
+};
+
+inline TableGlyphCache::TableGlyphCache(TFT_eSPI *tft, const char *characters, uint8_t maxPairs) :
+  tft(tft), height(0), pairSize(0), maxPairs(maxPairs), pairCount(0), nextPair(0) {
+  strncpy(this->characters, characters, TABLE_GLYPHS_SIZE);
+  this->characters[TABLE_GLYPHS_SIZE] = '\0';
+  pairs = new Pair[maxPairs];
+}
+
+inline TableGlyphCache::~TableGlyphCache() {
+  clear();
+  delete[] pairs;
+}
+
+//smooth (.vlw) and free (GFX) fonts are measured and drawn differently, the sprite would not get them
+inline bool TableGlyphCache::isBuiltinFont() const {
+#ifdef SMOOTH_FONT
+  if (tft->fontLoaded)
+    return false;
+#endif
+#ifdef LOAD_GFXFF
+  if (tft->gfxFont != nullptr)
+    return false;
+#endif
+  return true;
+}
+
+inline bool TableGlyphCache::covers(const char *text) const {
+  for (; *text != '\0'; text++) {
+    if (indexOf(*text) < 0)
+      return false;
+  }
+  return true;
+}
+
+inline bool TableGlyphCache::draw(int32_t x, int32_t y, const char *text, const char *previous, uint16_t color,
+    uint16_t background, uint16_t &width, uint32_t &pixels) {
+  if (tft->textdatum != MC_DATUM || !isBuiltinFont() || !covers(text))
+    return false;
+
+  auto glyphs = pixelsOf(color, background);
+  if (glyphs == nullptr)
+    return false;
+
+  if (previous != nullptr && !covers(previous))
+    previous = nullptr;
+
+  //same rounding as drawString()
+  uint16_t textWidth = widthOf(text);
+  int32_t left = x - textWidth / 2;
+  int32_t top = y - height / 2;
+  int32_t previousLeft = x - width / 2;
+  int32_t previousPosition = previousLeft;
+
+  pixels = 0;
+  auto position = left;
+  for (; *text != '\0'; text++) {
+    auto glyph = indexOf(*text);
+
+    //the previous glyph at this position, if one starts exactly here
+    while (previous != nullptr && *previous != '\0' && previousPosition < position)
+      previousPosition += widths[indexOf(*previous++)];
+
+    if (previous == nullptr || *previous != *text || previousPosition != position) {
+      tft->setAddrWindow(position, top, widths[glyph], height);
+      tft->pushColors(const_cast<uint16_t *>(glyphs + offsets[glyph]), widths[glyph] * height, true);
+      pixels += widths[glyph] * height;
+    }
+    position += widths[glyph];
+  }
+
+  //padding: what the previous text covered beyond the new one
+  if (previousLeft < left) {
+    tft->fillRect(previousLeft, top, left - previousLeft, height, background);
+    pixels += (left - previousLeft) * height;
+  }
+  if (previousLeft + width > position) {
+    tft->fillRect(position, top, previousLeft + width - position, height, background);
+    pixels += (previousLeft + width - position) * height;
+  }
+
+  width = textWidth;
+  return true;
+}
+
+inline void TableGlyphCache::clear() {
+  for (uint8_t i = 0; i < pairCount; i++)
+    delete[] pairs[i].pixels;
+  pairCount = 0;
+  nextPair = 0;
+  height = 0;
+}
+
+inline uint32_t TableGlyphCache::getBytes() const {
+  return sizeof(uint16_t) * pairSize * pairCount;
+}
+
+inline int8_t TableGlyphCache::indexOf(char character) const {
+  if (character == '\0')
+    return -1;
+
+  auto found = strchr(characters, character);
+  return found != nullptr ? found - characters : -1;
+}
+
+inline uint16_t TableGlyphCache::widthOf(const char *text) const {
+  uint16_t width = 0;
+  for (; *text != '\0'; text++)
+    width += widths[indexOf(*text)];
+  return width;
+}
+
+//glyph sizes as the screen's font reports them
+inline bool TableGlyphCache::measure() {
+  height = tft->fontHeight();
+  pairSize = 0;
+
+  char glyph[2] = {0, 0};
+  for (uint8_t i = 0; characters[i] != '\0'; i++) {
+    glyph[0] = characters[i];
+    widths[i] = tft->textWidth(glyph);
+    offsets[i] = pairSize;
+    pairSize += widths[i] * height;
+  }
+
+  return height > 0 && pairSize > 0;
+}
+
+inline const uint16_t *TableGlyphCache::pixelsOf(uint16_t color, uint16_t background) {
+  if (height == 0 && !measure())
+    return nullptr;
+
+  for (uint8_t i = 0; i < pairCount; i++) {
+    if (pairs[i].color == color && pairs[i].background == background)
+      return pairs[i].pixels;
+  }
+
+  if (maxPairs == 0)
+    return nullptr;
+
+  Pair *pair;
+  if (pairCount < maxPairs) {
+    pair = &pairs[pairCount];
+    pair->pixels = new uint16_t[pairSize];
+    pairCount++;
+  }
+  else {
+    pair = &pairs[nextPair];
+    nextPair = (nextPair + 1) % maxPairs;
+  }
+
+  pair->color = color;
+  pair->background = background;
+  if (rasterize(*pair))
+    return pair->pixels;
+
+  //the slot holds no valid glyphs, the last pair takes its place
+  delete[] pair->pixels;
+  *pair = pairs[--pairCount];
+  nextPair = nextPair < pairCount ? nextPair : 0;
+  return nullptr;
+}
+
+//each glyph is drawn at the top left of a sprite in the screen's font and read back
+inline bool TableGlyphCache::rasterize(Pair &pair) {
+  if (!isBuiltinFont())
+    return false;
+
+  uint16_t widest = 0;
+  for (uint8_t i = 0; characters[i] != '\0'; i++)
+    widest = widths[i] > widest ? widths[i] : widest;
+
+  TFT_eSprite sprite(tft);
+  sprite.setColorDepth(16);
+  if (sprite.createSprite(widest, height) == nullptr)
+    return false;
+
+  sprite.setTextFont(tft->textfont);
+  sprite.setTextSize(tft->textsize);
+  sprite.setTextColor(pair.color, pair.background);
+  sprite.setTextDatum(TL_DATUM);
+
+  char glyph[2] = {0, 0};
+  for (uint8_t i = 0; characters[i] != '\0'; i++) {
+    glyph[0] = characters[i];
+    sprite.fillSprite(pair.background);
+    sprite.drawString(glyph, 0, 0);
+
+    auto block = pair.pixels + offsets[i];
+    for (uint16_t row = 0; row < height; row++) {
+      for (uint16_t column = 0; column < widths[i]; column++)
+        *block++ = sprite.readPixel(column, row);
+    }
+  }
+
+  sprite.deleteSprite();
+  return true;
+}
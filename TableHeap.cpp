@@ -1,160 +1,256 @@
 #include "TableHeap.h"
 
 TableHeap::TableHeap(TFT_eSPI *tft, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
-             uint8_t rows, uint8_t columns, uint16_t outlineColor, uint16_t fillColor)
-    : tft(tft), x(x), y(y), paddingTop(0), paddingBottom(0), paddingLeft(0), paddingRight(0),
+             uint8_t rows, uint8_t columns, uint16_t outlineColor, uint16_t fillColor, uint8_t paletteBits,
+             TableArena *arena)
+    : TableRender(tft), x(x), y(y), paddingTop(0), paddingBottom(0), paddingLeft(0), paddingRight(0),
       rows(rows), columns(columns), outlineColor(outlineColor),
-      fillColor(fillColor), width(width), height(height) {
+      fillColor(fillColor), paletteBits(paletteBits), width(width), height(height), arena(arena) {
 
   allocateArrays();
 }
 
 void TableHeap::generate() {
-  calculateColumnWidths();
-  calculateRowHeights();
-  calculateCellCoordinates();
-  calculateCellCenters();
+  relayout();
 }
 
-void TableHeap::calculateColumnWidths() {
-  auto remainingWidth = width - (paddingLeft + paddingRight);
-
-  auto specifiedColumns = 0;
-  for (auto i = 0; i < columns; i++) {
-    if (columnWidths[i] != 0) {
-      specifiedColumns++;
-      remainingWidth -= columnWidths[i];
-    }
+//sizes from the specified ones, offsets from the first changed column/row on. Every cell in a changed
+//column or row is marked dirty; the damage rectangle spans both the old and the new extent, so the
+//caller can clear what the table no longer covers when it shrank.
+TableRect TableHeap::relayout() {
+  uint16_t left = columnOffsets[0];
+  uint16_t top = rowOffsets[0];
+  auto right = columnOffsets[columns];
+  auto bottom = rowOffsets[rows];
+
+  auto column = tableRelayout(columnSpecs, columnWidths, columnOffsets, columns, x + paddingLeft,
+    width - paddingLeft - paddingRight);
+  auto row = tableRelayout(rowSpecs, rowHeights, rowOffsets, rows, y + paddingTop,
+    height - paddingTop - paddingBottom);
+
+  if (column == columns && row == rows)
+    return TableRect{columnOffsets[0], rowOffsets[0], 0, 0};
+
+  for (auto r = 0; r < rows; r++) {
+    for (auto c = r < row ? column : 0; c < columns; c++)
+      markDirty(r, c);
   }
 
-  float remainingColumns = columns - specifiedColumns;
-  auto equalWidth = round(remainingWidth / remainingColumns);
+  //offsets before the first changed index stay where they were, a moved origin takes the lower one
+  if (row == rows && column > 0)
+    left = columnOffsets[column];
+  else if (columnOffsets[0] < left)
+    left = columnOffsets[0];
+  if (column == columns && row > 0)
+    top = rowOffsets[row];
+  else if (rowOffsets[0] < top)
+    top = rowOffsets[0];
+  right = right > columnOffsets[columns] ? right : columnOffsets[columns];
+  bottom = bottom > rowOffsets[rows] ? bottom : rowOffsets[rows];
+  return TableRect{left, top, static_cast<uint16_t>(right - left), static_cast<uint16_t>(bottom - top)};
+}
+
+//the scanlines are built in a buffer kept from the previous call, or taken anew when the table got wider
+void TableHeap::drawScanlines() {
+  auto width = getWidth();
+
+  if (width == 0 || getHeight() == 0)
+    return;
 
-  auto currentOffset = paddingLeft;
-  for (auto i = 0; i < columns; i++) {
-    if (columnWidths[i] == 0)
-      columnWidths[i] = equalWidth;
-    currentOffset += columnWidths[i];
+  if (lineBufferLength < width) {
+    release(lineBuffer);
+    lineBuffer = static_cast<uint16_t *>(allocate(sizeof(uint16_t) * 2 * width));
+    lineBufferLength = lineBuffer != nullptr ? width : 0;
+    if (lineBuffer == nullptr)
+      return;
   }
+
+  //one scanline for the top/bottom outline of a row, one for the pixel rows in between
+  pushScanlines(lineBuffer, lineBuffer + width);
 }
 
-void TableHeap::calculateRowHeights() {
-  auto remainingHeight = height - (paddingTop + paddingBottom);
+const char *TableHeap::getCellText(uint8_t row, uint8_t column) const {
+  if (cellTexts == nullptr)
+    return "";
 
-  auto specifiedRows = 0;
-  for (auto i = 0; i < rows; i++) {
-    if (rowHeights[i] != 0) {
-      specifiedRows++;
-      remainingHeight -= rowHeights[i];
-    }
-  }
+  return cellTexts[row * columns + column].text;
+}
 
-  auto remainingRows = rows - specifiedRows;
-  float equalHeight = round(remainingHeight / remainingRows);
+TableCellText *TableHeap::acquireTexts() {
+  if (cellTexts == nullptr && !allocateTexts())
+    return nullptr;
 
-  auto currentOffset = paddingTop;
-  for (auto i = 0; i < rows; i++) {
-    if (rowHeights[i] == 0)
-      rowHeights[i] = equalHeight;
-    currentOffset += rowHeights[i];
-  }
+  return cellTexts;
 }
 
-void TableHeap::calculateCellCoordinates() {
-  auto currentX = x + paddingLeft;
-  auto currentY = y + paddingTop;
+//cell texts are only allocated once updateCellText() is used, false when they can't be
+bool TableHeap::allocateTexts() {
+  if (!isValid())
+    return false;
 
-  for (auto row = 0; row < rows; row++) {
-    currentX = paddingLeft;
-    for (auto column = 0; column < columns; column++) {
-      cellXCoordinates[row][column] = currentX;
-      currentX += columnWidths[column];
-    }
+  cellTexts = static_cast<TableCellText *>(allocate(sizeof(TableCellText) * rows * columns));
+  if (cellTexts == nullptr)
+    return false;
 
-    for (auto i = 0; i < columns; i++) {
-      cellYCoordinates[row][i] = currentY;
-    }
+  memset(cellTexts, 0, sizeof(TableCellText) * rows * columns);
+  return true;
+}
 
-    currentY += rowHeights[row];
-  }
+void TableHeap::setCellFillColor(uint8_t row, uint8_t column, uint16_t color) {
+  if (getCellFillColor(row, column) == color)
+    return;
+
+  if (paletteBits == 0)
+    cellColors[row * columns + column] = color;
+  else
+    storeFillIndex(row * columns + column, paletteIndexOf(color));
+
+  markDirty(row, column);
 }
 
-void TableHeap::calculateCellCenters() {
-  for (auto row = 0; row < rows; row++) {
-    auto trueY = y + paddingTop;
-    for (auto i = 0; i < row; i++) {
-      trueY += rowHeights[i];
-    }
+void TableHeap::setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color) {
+  if (getCellOutlineColor(row, column) == color)
+    return;
 
-    for (auto column = 0; column < columns; column++) {
-      auto x = cellXCoordinates[row][column] + columnWidths[column] / 2;
-      cellCenters[row][column][0] = x;
-      cellCenters[row][column][1] =  trueY + rowHeights[row] / 2;
-    }
+  if (paletteBits == 0)
+    cellColors[rows * columns + row * columns + column] = color;
+  else
+    storeOutlineIndex(row * columns + column, paletteIndexOf(color));
+
+  markDirty(row, column);
+}
+
+uint16_t TableHeap::getCellFillColor(uint8_t row, uint8_t column) const {
+  auto cell = row * columns + column;
+  auto indices = reinterpret_cast<const uint8_t *>(cellColors);
+
+  switch (paletteBits) {
+  case 4:
+    return palette[indices[cell] & 0x0F];
+  case 8:
+    return palette[indices[cell]];
+  default:
+    return cellColors[cell];
+  }
+}
+
+uint16_t TableHeap::getCellOutlineColor(uint8_t row, uint8_t column) const {
+  auto cell = row * columns + column;
+  auto indices = reinterpret_cast<const uint8_t *>(cellColors);
+
+  switch (paletteBits) {
+  case 4:
+    return palette[indices[cell] >> 4];
+  case 8:
+    return palette[indices[rows * columns + cell]];
+  default:
+    return cellColors[rows * columns + cell];
   }
 }
 
-void TableHeap::draw() const {
+void TableHeap::setCellFillIndex(uint8_t row, uint8_t column, uint8_t index) {
+  if (paletteBits == 0 || index >= 1 << paletteBits)
+    return;
+
+  storeFillIndex(row * columns + column, index);
+  markDirty(row, column);
+}
+
+void TableHeap::setCellOutlineIndex(uint8_t row, uint8_t column, uint8_t index) {
+  if (paletteBits == 0 || index >= 1 << paletteBits)
+    return;
+
+  storeOutlineIndex(row * columns + column, index);
+  markDirty(row, column);
+}
+
+//recolors every cell using this entry, only those cells are marked dirty
+void TableHeap::setPaletteColor(uint8_t index, uint16_t color) {
+  if (paletteBits == 0 || index >= 1 << paletteBits)
+    return;
+
+  if (paletteUsed <= index)
+    paletteUsed = index + 1;
+
+  if (palette[index] == color)
+    return;
+
+  palette[index] = color;
+
+  auto indices = reinterpret_cast<const uint8_t *>(cellColors);
   for (auto row = 0; row < rows; row++) {
     for (auto column = 0; column < columns; column++) {
-      auto x = cellXCoordinates[row][column];
-      auto y = cellYCoordinates[row][column];
-      auto width = columnWidths[column];
-      auto height = rowHeights[row];
-      auto fillColor = cellFillColors[row][column];
-      auto outlineColor = cellOutlineColors[row][column];
-
-      tft->fillRect(x, y, width, height, fillColor);
-      tft->drawRect(x, y, width, height, outlineColor);
+      auto cell = row * columns + column;
+      auto used = paletteBits == 4
+        ? (indices[cell] & 0x0F) == index || indices[cell] >> 4 == index
+        : indices[cell] == index || indices[rows * columns + cell] == index;
+
+      if (used)
+        markDirty(row, column);
     }
   }
 }
 
-void TableHeap::drawCellText(uint8_t row, uint8_t column, String text, uint16_t clr) const {
-  tft->setTextColor(clr);
+uint16_t TableHeap::getPaletteColor(uint8_t index) const {
+  if (paletteBits == 0 || index >= 1 << paletteBits)
+    return 0;
 
-  auto x = cellCenters[row][column][0];
-  auto y = cellCenters[row][column][1];
+  return palette[index];
+}
 
-  tft->drawString(text, x, y);
+void TableHeap::storeFillIndex(uint16_t cell, uint8_t index) {
+  auto indices = reinterpret_cast<uint8_t *>(cellColors);
 
-  tft->setTextColor(ILI9486_WHITE);
+  if (paletteBits == 4)
+    indices[cell] = (indices[cell] & 0xF0) | (index & 0x0F);
+  else
+    indices[cell] = index;
 }
 
-void TableHeap::drawCellOutline(uint8_t row, uint8_t column) const {
-  auto x = cellXCoordinates[row][column];
-  auto y = cellYCoordinates[row][column];
-  auto width = columnWidths[column];
-  auto height = rowHeights[row];
-  auto outlineColor = cellOutlineColors[row][column];
+void TableHeap::storeOutlineIndex(uint16_t cell, uint8_t index) {
+  auto indices = reinterpret_cast<uint8_t *>(cellColors);
 
-  tft->drawRect(x, y, width, height, outlineColor);
+  if (paletteBits == 4)
+    indices[cell] = (indices[cell] & 0x0F) | (index << 4);
+  else
+    indices[rows * columns + cell] = index;
 }
 
-void TableHeap::eraseCell(uint8_t row, uint8_t column) const {
-  auto x = cellXCoordinates[row][column];
-  auto y = cellYCoordinates[row][column];
-  auto width = columnWidths[column];
-  auto height = rowHeights[row];
-  auto fillColor = cellFillColors[row][column];
+//an existing entry holding the color, else the next unused entry, else the closest color in the palette
+uint8_t TableHeap::paletteIndexOf(uint16_t color) {
+  for (uint16_t i = 0; i < paletteUsed; i++) {
+    if (palette[i] == color)
+      return i;
+  }
 
-  tft->fillRect(x + 1, y + 1, width - 2, height - 2, fillColor);
-}
+  if (paletteUsed < (1 << paletteBits)) {
+    palette[paletteUsed] = color;
+    return paletteUsed++;
+  }
 
-void TableHeap::setCellFillColor(uint8_t row, uint8_t column, uint16_t color) {
-  cellFillColors[row][column] = color;
-}
+  uint8_t closest = 0;
+  uint32_t closestDistance = UINT32_MAX;
+  for (uint16_t i = 0; i < paletteUsed; i++) {
+    int32_t red = (palette[i] >> 11) - (color >> 11);
+    int32_t green = ((palette[i] >> 5) & 0x3F) - ((color >> 5) & 0x3F);
+    int32_t blue = (palette[i] & 0x1F) - (color & 0x1F);
+    uint32_t distance = 4 * red * red + green * green + 4 * blue * blue;
+
+    if (distance < closestDistance) {
+      closest = i;
+      closestDistance = distance;
+    }
+  }
 
-void TableHeap::setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color) {
-  cellOutlineColors[row][column] = color;
+  return closest;
 }
 
 void TableHeap::setRowHeight(uint8_t row, uint16_t height) {
-  rowHeights[row] = height;
+  rowSpecs[row] = height;
 }
 
 void TableHeap::setColumnWidth(uint8_t column, uint16_t width) {
-  columnWidths[column] = width;
+  columnSpecs[column] = width;
 }
 
 void TableHeap::setPaddingTop(uint16_t top) { paddingTop = top; }
@@ -198,50 +294,105 @@ uint16_t TableHeap::getHeight() const {
   return height;
 }
 
+//geometry, colors and dirty bits live in a single allocation, so a table costs one allocation
+//regardless of its size
+//direct colors: a fill and an outline plane of RGB565 values
+//4 bit palette: one byte per cell, fill index in the low and outline index in the high nibble
+//8 bit palette: a fill and an outline plane of one byte indices
+static uint32_t colorWordsOf(uint8_t rows, uint8_t columns, uint8_t paletteBits) {
+  uint32_t cells = rows * columns;
+  uint16_t paletteSize = paletteBits == 0 ? 0 : 1 << paletteBits;
+  return (paletteBits == 4 ? (cells + 1) / 2 : paletteBits == 8 ? cells : 2 * cells) + paletteSize;
+}
+
+static bool isPaletteBits(uint8_t paletteBits) {
+  return paletteBits == 0 || paletteBits == 4 || paletteBits == 8;
+}
+
+//geometry words, color words, then the dirty bits
+size_t TableHeap::requiredBytes(uint8_t rows, uint8_t columns, uint8_t paletteBits) {
+  if (!isPaletteBits(paletteBits))
+    return 0;
+  return sizeof(uint16_t) * (3 * columns + 3 * rows + 2 + colorWordsOf(rows, columns, paletteBits))
+    + (rows * columns + 7) / 8;
+}
+
+void *TableHeap::allocate(size_t size) {
+  return arena != nullptr ? arena->allocate(size) : new uint8_t[size];
+}
+
+//arena memory is only given back by the arena itself
+void TableHeap::release(void *buffer) {
+  if (arena == nullptr)
+    delete[] static_cast<uint8_t *>(buffer);
+}
+
 void TableHeap::allocateArrays() {
-  columnWidths = new uint16_t[columns];
-  rowHeights = new uint16_t[rows];
-  cellCenters = new uint16_t **[rows];
-  cellFillColors = new uint16_t *[rows];
-  cellOutlineColors = new uint16_t *[rows];
-  cellXCoordinates = new uint16_t *[rows];
-  cellYCoordinates = new uint16_t *[rows];
-
-  memset(columnWidths, 0, sizeof(uint16_t) * columns);
-  memset(rowHeights, 0, sizeof(uint16_t) * rows);
-
-  for (auto i = 0; i < rows; i++) {
-    cellCenters[i] = new uint16_t *[columns];
-    cellFillColors[i] = new uint16_t[columns];
-    cellOutlineColors[i] = new uint16_t[columns];
-    cellXCoordinates[i] = new uint16_t[columns];
-    cellYCoordinates[i] = new uint16_t[columns];
-
-    for (auto j = 0; j < columns; j++) {
-      cellCenters[i][j] = new uint16_t[2];
-      cellFillColors[i][j] = fillColor;
-      cellOutlineColors[i][j] = outlineColor;
-    }
+  //other paletteBits have no color layout, such a table is as empty as one without memory
+  block = nullptr;
+  if (isPaletteBits(paletteBits))
+    block = static_cast<uint8_t *>(allocate(requiredBytes(rows, columns, paletteBits)));
+  cellTexts = nullptr;
+  lineBuffer = nullptr;
+  lineBufferLength = 0;
+
+  //an empty table whose arrays all point to a few spare words, so every call stays in bounds
+  if (block == nullptr) {
+    rows = 0;
+    columns = 0;
+    paletteBits = 0;
+    paletteUsed = 0;
+    memset(spare, 0, sizeof(spare));
+    columnWidths = rowHeights = columnSpecs = rowSpecs = spare;
+    columnOffsets = spare;
+    rowOffsets = spare + 2;
+    cellColors = palette = spare;
+    dirtyCells = reinterpret_cast<uint8_t *>(spare);
+    return;
   }
-}
 
-TableHeap::~TableHeap() {
-  for (auto i = 0; i < rows; i++) {
-    for (auto j = 0; j < columns; j++) {
-      delete[] cellCenters[i][j];
+  auto cells = rows * columns;
+
+  columnWidths = reinterpret_cast<uint16_t *>(block);
+  rowHeights = columnWidths + columns;
+  columnOffsets = rowHeights + rows;
+  rowOffsets = columnOffsets + columns + 1;
+  columnSpecs = rowOffsets + rows + 1;
+  rowSpecs = columnSpecs + columns;
+
+  uint16_t paletteSize = paletteBits == 0 ? 0 : 1 << paletteBits;
+  cellColors = rowSpecs + rows;
+  palette = cellColors + colorWordsOf(rows, columns, paletteBits) - paletteSize;
+  paletteUsed = 0;
+
+  dirtyCells = reinterpret_cast<uint8_t *>(palette + paletteSize);
+
+  memset(columnWidths, 0, sizeof(uint16_t) * (3 * columns + 3 * rows + 2));
+  memset(dirtyCells, 0, (cells + 7) / 8);
+
+  if (paletteBits == 0) {
+    for (auto i = 0; i < cells; i++) {
+      cellColors[i] = fillColor;
+      cellColors[cells + i] = outlineColor;
     }
-    delete[] cellCenters[i];
-    delete[] cellFillColors[i];
-    delete[] cellOutlineColors[i];
-    delete[] cellXCoordinates[i];
-    delete[] cellYCoordinates[i];
+    return;
   }
 
-  delete[] columnWidths;
-  delete[] rowHeights;
-  delete[] cellCenters;
-  delete[] cellFillColors;
-  delete[] cellOutlineColors;
-  delete[] cellXCoordinates;
-  delete[] cellYCoordinates;
+  memset(palette, 0, sizeof(uint16_t) * paletteSize);
+  auto fillIndex = paletteIndexOf(fillColor);
+  auto outlineIndex = paletteIndexOf(outlineColor);
+  for (auto i = 0; i < cells; i++) {
+    storeFillIndex(i, fillIndex);
+    storeOutlineIndex(i, outlineIndex);
+  }
 }
+
+bool TableHeap::isValid() const {
+  return block != nullptr;
+}
+
+TableHeap::~TableHeap() {
+  release(block);
+  release(cellTexts);
+  release(lineBuffer);
+}
\ No newline at end of file
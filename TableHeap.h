@@ -1,25 +1,57 @@
-//BUG: rounding errors if incorrect values are passed to setRowHeight and setColumnWidth, relative to table's size
+//NOTE: sizes passed to setRowHeight and setColumnWidth that add up to more than the table's size leave the remaining rows/columns 0 pixels
 
 #pragma once
 
 #include <SPI.h>
 #include <TFT_eSPI.h>
 
-class TableHeap {
+#include "TableArena.h"
+#include "TableLayout.h"
+#include "TableRender.h"
+
+// drawing, dirty tracking, texts and hit testing come from TableRender, the table itself only holds
+// the layout and colors
+class TableHeap : public TableRender<TableHeap> {
 public:
+	// geometry, colors and dirty bits share one allocation, made with new or, given an arena, taken
+	// from it (at least requiredBytes()); cell texts and the scanline buffer are allocated separately
+	// on first use, since most tables never need them and the scanlines grow with the table's width.
+	// When the arena can't supply the block, or paletteBits is not 0, 4 or 8, the table is empty (0 rows
+	// and columns, see isValid()) and draws nothing; updateCellText()/updateCells() and drawScanlines()
+	// do nothing when their buffers can't be taken from the arena
 	TableHeap(TFT_eSPI *tft, uint16_t x, uint16_t y, uint16_t width, uint16_t height,
-		uint8_t rows, uint8_t columns, uint16_t outlineColor, uint16_t fillColor);
+		uint8_t rows, uint8_t columns, uint16_t outlineColor, uint16_t fillColor, uint8_t paletteBits = 0,
+		TableArena *arena = nullptr);
+
+	// size of the block above; updateCellText() adds rows * columns * sizeof(TableCellText) and
+	// drawScanlines() 4 * width bytes; 0 for unsupported paletteBits
+	static size_t requiredBytes(uint8_t rows, uint8_t columns, uint8_t paletteBits = 0);
+	// false when the block couldn't be allocated or paletteBits is unsupported
+	bool isValid() const;
 
 	void generate();
-	void draw() const;
+	// applies setRowHeight(), setColumnWidth() and padding changes to an already generated table:
+	// offsets are rewritten from the first changed column/row on and only cells whose geometry changed
+	// are marked dirty for flush(), step() or flushSprite(). Returns the area they covered before and
+	// after (width 0 when nothing changed), clear the part no longer covered by the table if it shrank.
+	TableRect relayout();
+	void drawScanlines();
 
-	void eraseCell(uint8_t row, uint8_t column) const;
-	void drawCellText(uint8_t row, uint8_t column, String text, uint16_t clr) const;
-	void drawCellOutline(uint8_t row, uint8_t column) const;
+	const char *getCellText(uint8_t row, uint8_t column) const;
 
 	void setCellFillColor(uint8_t row, uint8_t column, uint16_t color);
 	void setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color);
+	uint16_t getCellFillColor(uint8_t row, uint8_t column) const;
+	uint16_t getCellOutlineColor(uint8_t row, uint8_t column) const;
+
+	// palette mode only (paletteBits 4 or 8), ignored otherwise; indices of 1 << paletteBits and up are
+	// rejected: the setters do nothing and getPaletteColor() returns 0
+	void setCellFillIndex(uint8_t row, uint8_t column, uint8_t index);
+	void setCellOutlineIndex(uint8_t row, uint8_t column, uint8_t index);
+	void setPaletteColor(uint8_t index, uint16_t color);
+	uint16_t getPaletteColor(uint8_t index) const;
 
+	// 0 shares the remaining space with the other such rows/columns, takes effect on generate() or relayout()
 	void setRowHeight(uint8_t row, uint16_t height);
 	void setColumnWidth(uint8_t column, uint16_t width);
 
@@ -38,8 +70,6 @@ public:
 	~TableHeap();
 
 	private:
-	TFT_eSPI *tft;
-
 	uint16_t x;
 	uint16_t y;
 	uint16_t width;
@@ -49,19 +79,56 @@ public:
 
 	uint16_t paddingTop, paddingBottom, paddingLeft, paddingRight;
 
+	// nullptr allocates with new
+	TableArena *arena;
+	// every array up to dirtyCells points into this allocation, or into spare when it failed
+	uint8_t *block;
+	uint16_t spare[4];
+
+	// rowHeights, the offsets and the specs follow columnWidths
 	uint16_t *columnWidths;
 	uint16_t *rowHeights;
-	uint16_t ***cellCenters;
-	uint16_t** cellXCoordinates;
-	uint16_t** cellYCoordinates;
+	// columns + 1 and rows + 1 absolute screen coordinates, the last entry is the table's far edge
+	uint16_t *columnOffsets;
+	uint16_t *rowOffsets;
+	// sizes passed to setColumnWidth() and setRowHeight(), 0 = automatic
+	uint16_t *columnSpecs;
+	uint16_t *rowSpecs;
 
 	uint16_t outlineColor, fillColor;
-	uint16_t **cellFillColors;
-	uint16_t **cellOutlineColors;
 
+	// 0 stores RGB565 colors per cell, 4 or 8 stores per cell indices into a palette of 16 or 256 colors
+	uint8_t paletteBits;
+	uint16_t paletteUsed;
+
+	// row-major color planes, layout depends on paletteBits (see allocateArrays()),
+	// followed by the palette
+	uint16_t *cellColors;
+	uint16_t *palette;
+
+	// one bit per cell, row-major; set by the color setters, consumed by flush() and step()
+	uint8_t *dirtyCells;
+
+	// last text drawn by updateCellText() per cell, allocated on first use
+	TableCellText *cellTexts;
+
+	// two scanlines for drawScanlines(), allocated on first use
+	uint16_t *lineBuffer;
+	uint16_t lineBufferLength;
+
+	void *allocate(size_t size);
+	void release(void *buffer);
 	void allocateArrays();
-	void calculateColumnWidths();
-	void calculateRowHeights();
-	void calculateCellCenters();
-	void calculateCellCoordinates();
-};
\ No newline at end of file
+	bool allocateTexts();
+	void storeFillIndex(uint16_t cell, uint8_t index);
+	void storeOutlineIndex(uint16_t cell, uint8_t index);
+	uint8_t paletteIndexOf(uint16_t color);
+
+	// storage TableRender draws from
+	friend class TableRender<TableHeap>;
+	static constexpr bool storesTexts = true;
+	TableAxis columnAxis() const { return TableAxis{columnOffsets, columnWidths}; }
+	TableAxis rowAxis() const { return TableAxis{rowOffsets, rowHeights}; }
+	TableCellText *storedTexts() { return cellTexts; }
+	TableCellText *acquireTexts();
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <stdint.h>
+
+//compile-time column/row layout used by TableFlash. Written against C++11 constexpr rules
+//(single-return functions) so it builds with every Arduino core TFT_eSPI supports.
+
+//what the cellAt() lookups return for points outside every cell (padding included)
+#define TABLE_NO_CELL 0xFFFF
+
+//binary search for the span [offsets[i], offsets[i + 1]) holding value among count spans, count when the
+//value is outside all of them
+inline uint8_t tableSpanAt(const uint16_t* offsets, uint8_t count, uint16_t value) {
+    if (value < offsets[0] || value >= offsets[count])
+        return count;
+
+    uint8_t low = 0, high = count;
+    while (high - low > 1) {
+        uint8_t middle = (low + high) / 2;
+        if (offsets[middle] <= value)
+            low = middle;
+        else
+            high = middle;
+    }
+    return low;
+}
+
+//screen area, e.g. what relayout() reports as damaged
+struct TableRect {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+};
+
+//runtime counterpart of TableLayout for one axis: entries with a specified (non-zero) size keep it, the
+//others share what is left of extent, the first (left % shared) of them one pixel larger so the sizes
+//add up exactly. Offsets are only rewritten from the first entry whose position or size changed,
+//which is returned (count when nothing changed).
+inline uint8_t tableRelayout(const uint16_t* specified, uint16_t* sizes, uint16_t* offsets, uint8_t count,
+    uint16_t origin, uint16_t extent) {
+    uint32_t fixed = 0;
+    uint8_t shared = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        fixed += specified[i];
+        shared += specified[i] == 0;
+    }
+
+    uint16_t left = fixed < extent ? extent - fixed : 0;
+    uint16_t base = shared > 0 ? left / shared : 0;
+    uint16_t extra = shared > 0 ? left % shared : 0;
+
+    uint8_t changed = offsets[0] != origin ? 0 : count;
+    for (uint8_t i = 0, sharedBefore = 0; i < count; i++) {
+        uint16_t size = specified[i];
+        if (size == 0)
+            size = base + (sharedBefore++ < extra ? 1 : 0);
+
+        if (size != sizes[i] && changed == count)
+            changed = i;
+        sizes[i] = size;
+    }
+
+    if (changed == 0)
+        offsets[0] = origin;
+    for (uint8_t i = changed; i < count; i++)
+        offsets[i + 1] = offsets[i] + sizes[i];
+
+    return changed;
+}
+
+//fixed sizes in pixels, 0 shares the remaining space equally between all such entries
+template <uint16_t... Sizes>
+struct TableSizes {
+    static constexpr uint8_t count = sizeof...(Sizes);
+    static constexpr uint16_t specified[sizeof...(Sizes)] = {Sizes...};
+
+    //sum of the fixed sizes in [0, index)
+    static constexpr uint16_t fixedBefore(uint8_t index) {
+        return index == 0 ? 0 : specified[index - 1] + fixedBefore(index - 1);
+    }
+
+    //number of shared entries in [0, index)
+    static constexpr uint8_t sharedBefore(uint8_t index) {
+        return index == 0 ? 0 : (specified[index - 1] == 0) + sharedBefore(index - 1);
+    }
+
+    //every shared entry gets base pixels, the first extra shared entries one more, so the sizes add up
+    //to the extent exactly
+    static constexpr uint16_t size(uint8_t index, uint16_t base, uint16_t extra) {
+        return specified[index] != 0 ? specified[index] : base + (sharedBefore(index) < extra ? 1 : 0);
+    }
+
+    //sum of the sizes in [0, index)
+    static constexpr uint16_t offset(uint8_t index, uint16_t base, uint16_t extra) {
+        return fixedBefore(index) + sharedBefore(index) * base
+            + (sharedBefore(index) < extra ? sharedBefore(index) : extra);
+    }
+};
+
+template <uint16_t... Sizes>
+constexpr uint16_t TableSizes<Sizes...>::specified[sizeof...(Sizes)];
+
+template <uint8_t... Indices>
+struct TableIndices {};
+
+template <uint8_t Count, uint8_t... Indices>
+struct TableMakeIndices : TableMakeIndices<Count - 1, Count - 1, Indices...> {};
+
+template <uint8_t... Indices>
+struct TableMakeIndices<0, Indices...> {
+    typedef TableIndices<Indices...> type;
+};
+
+//sizes, absolute offsets (count + 1, the last one is the far edge) and centers along one axis
+template <uint16_t Origin, uint16_t Extent, class Sizes, class Indices = typename TableMakeIndices<Sizes::count>::type>
+struct TableLayout;
+
+template <uint16_t Origin, uint16_t Extent, class Sizes, uint8_t... Indices>
+struct TableLayout<Origin, Extent, Sizes, TableIndices<Indices...>> {
+    static constexpr uint16_t fixed = Sizes::fixedBefore(Sizes::count);
+    static constexpr uint8_t shared = Sizes::sharedBefore(Sizes::count);
+
+    static_assert(fixed <= Extent, "fixed sizes exceed the table's size");
+    static_assert(shared > 0 || fixed == Extent, "fixed sizes must add up to the table's size when no size is shared");
+
+    static constexpr uint16_t base = shared > 0 ? (Extent - fixed) / shared : 0;
+    static constexpr uint16_t extra = shared > 0 ? (Extent - fixed) % shared : 0;
+
+    static constexpr uint16_t sizes[sizeof...(Indices)] = {Sizes::size(Indices, base, extra)...};
+    static constexpr uint16_t offsets[sizeof...(Indices) + 1] = {
+        static_cast<uint16_t>(Origin + Sizes::offset(Indices, base, extra))...,
+        static_cast<uint16_t>(Origin + Extent)};
+    static constexpr uint16_t centers[sizeof...(Indices)] = {
+        static_cast<uint16_t>(Origin + Sizes::offset(Indices, base, extra) + Sizes::size(Indices, base, extra) / 2)...};
+};
+
+template <uint16_t Origin, uint16_t Extent, class Sizes, uint8_t... Indices>
+constexpr uint16_t TableLayout<Origin, Extent, Sizes, TableIndices<Indices...>>::sizes[sizeof...(Indices)];
+
+template <uint16_t Origin, uint16_t Extent, class Sizes, uint8_t... Indices>
+constexpr uint16_t TableLayout<Origin, Extent, Sizes, TableIndices<Indices...>>::offsets[sizeof...(Indices) + 1];
+
+template <uint16_t Origin, uint16_t Extent, class Sizes, uint8_t... Indices>
+constexpr uint16_t TableLayout<Origin, Extent, Sizes, TableIndices<Indices...>>::centers[sizeof...(Indices)];
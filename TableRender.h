@@ -0,0 +1,922 @@
+#pragma once
+
+#include <SPI.h>
+#include <TFT_eSPI.h>
+
+#include <type_traits>
+
+#include "TableGlyphs.h"
+#include "TableLayout.h"
+#include "TableStats.h"
+#include "TableText.h"
+
+//sizes and absolute offsets of a table's columns or rows, count + 1 offsets (the last one is the far edge)
+struct TableAxis {
+  const uint16_t *offsets;
+  const uint16_t *sizes;
+};
+
+//drawing, dirty tracking, stored texts and hit testing shared by TableHeap, TableStack and TableFlash,
+//which only differ in where they keep their layout, colors and texts. A table derives from
+//TableRender<Table>, makes it a friend and provides:
+//  getRows(), getColumns(), getWidth(), getHeight(), getCellFillColor(), getCellOutlineColor()
+//  columnAxis() and rowAxis(), the layout as TableAxis
+//  dirtyCells, one bit per cell in row-major order
+//  storedTexts(), the cell texts or nullptr while there are none
+//  acquireTexts(), the cell texts for updateCellText()/updateCells(), nullptr when they can't be had
+//  storesTexts, a static constexpr bool; false makes updateCellText() and updateCells() compile errors
+template <class Table>
+class TableRender {
+public:
+  void draw();
+  void flush();
+  //cooperative rendering: beginDraw() queues every cell for repainting, step() repaints queued and
+  //dirty cells until either budget is spent (0 = no limit) and returns true while cells remain.
+  //At least one cell is drawn per step.
+  void beginDraw();
+  bool step(uint32_t budgetMicros, uint32_t budgetPixels = 0);
+  //true while flush() or step() has cells to repaint
+  bool hasDirtyCells() const;
+  //flush() composed off-screen: each rectangle of dirty cells is drawn into sprite, text included,
+  //and pushed once, so no panel pixel is written twice. A rectangle takes at most maxBytes of sprite
+  //RAM: wider runs are split into groups of columns that fit, only a cell that doesn't fit on its own
+  //is drawn directly. Give the sprite the screen's font settings.
+  void flushSprite(TFT_eSprite *sprite, uint32_t maxBytes);
+
+  void eraseCell(uint8_t row, uint8_t column);
+  void drawCellOutline(uint8_t row, uint8_t column) const;
+
+  //the (text, length), integer and float overloads format into a per-table buffer, nothing is allocated
+  void drawCellText(uint8_t row, uint8_t column, const char *text, uint16_t clr) const;
+  void drawCellText(uint8_t row, uint8_t column, const char *text, size_t length, uint16_t clr) const;
+  void drawCellText(uint8_t row, uint8_t column, const String &text, uint16_t clr) const;
+  void drawCellText(uint8_t row, uint8_t column, float value, uint8_t decimals, uint16_t clr) const;
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value>::type
+  drawCellText(uint8_t row, uint8_t column, T value, uint16_t clr) const;
+
+  void updateCellText(uint8_t row, uint8_t column, const char *text, uint16_t clr);
+  void updateCellText(uint8_t row, uint8_t column, const char *text, size_t length, uint16_t clr);
+  void updateCellText(uint8_t row, uint8_t column, const String &text, uint16_t clr);
+  void updateCellText(uint8_t row, uint8_t column, float value, uint8_t decimals, uint16_t clr);
+  template <typename T>
+  typename std::enable_if<std::is_integral<T>::value>::type
+  updateCellText(uint8_t row, uint8_t column, T value, uint16_t clr);
+  //many updateCellText() calls in one bus transaction; sorts updates in place into raster order
+  void updateCells(TableCellUpdate *updates, uint16_t count);
+  //flush() and updateCells() in one pass for batches that restyle cells: texts of dirty cells are
+  //stored without drawing, so flush() paints each of them once with its new text, and only the cells
+  //that kept their style go through updateCells(). Sorts updates in place and reuses them
+  void applyCells(TableCellUpdate *updates, uint16_t count);
+  //texts stored by updateCellText()/updateCells() that consist only of the cache's characters are
+  //drawn from it, pushing only the glyphs that changed; nullptr draws every text with drawString()
+  void setGlyphCache(TableGlyphCache *cache);
+
+  //row * columns + column of the cell under a point, TABLE_NO_CELL outside the cells;
+  //O(log rows + log columns) over the offsets
+  uint16_t cellAt(uint16_t x, uint16_t y) const;
+  bool cellAt(uint16_t x, uint16_t y, uint8_t &row, uint8_t &column) const;
+  //count points at once (multi-touch, drag samples)
+  void cellsAt(const uint16_t *xs, const uint16_t *ys, uint16_t *cells, uint8_t count) const;
+
+  //top edge of a row, getRowY(getRows()) is the bottom edge of the last row
+  uint16_t getRowY(uint8_t row) const;
+
+#ifdef TABLE_STATS
+  //per operation counters since construction or the last resetStats()
+  TableStats getStats() const;
+  void resetStats();
+#endif
+
+protected:
+  TFT_eSPI *tft;
+
+  TableRender(TFT_eSPI *tft);
+
+  //the scanline half of drawScanlines(), each line holds getWidth() pixels
+  void pushScanlines(uint16_t *edgeLine, uint16_t *innerLine);
+  void markDirty(uint8_t row, uint8_t column);
+  bool isDirty(uint8_t row, uint8_t column) const;
+
+private:
+  TableGlyphCache *glyphs;
+  //cell step() continues from
+  uint16_t stepCursor;
+  //top left corner of the sprite composeBand() draws into, 0,0 while drawing to the screen
+  uint16_t originX, originY;
+
+  mutable char textBuffer[TABLE_TEXT_BUFFER_SIZE];
+
+#ifdef TABLE_STATS
+  mutable TableStats stats;
+#endif
+
+  Table &self() { return static_cast<Table &>(*this); }
+  const Table &self() const { return static_cast<const Table &>(*this); }
+
+  uint16_t cellX(uint8_t column) const { return self().columnAxis().offsets[column] - originX; }
+  uint16_t cellY(uint8_t row) const { return self().rowAxis().offsets[row] - originY; }
+  uint16_t cellWidth(uint8_t column) const { return self().columnAxis().sizes[column]; }
+  uint16_t cellHeight(uint8_t row) const { return self().rowAxis().sizes[row]; }
+
+  void clearDirty();
+  void drawCell(uint8_t row, uint8_t column);
+  bool isDirtyRun(uint8_t row, uint8_t first, uint8_t last) const;
+  bool composeBand(TFT_eSprite *sprite, uint8_t firstRow, uint8_t lastRow, uint8_t firstColumn, uint8_t lastColumn);
+  bool drawGlyphs(uint8_t row, uint8_t column, TableCellText &cell, const char *previous, uint16_t width);
+  void drawStoredText(uint8_t row, uint8_t column);
+  void drawStoredTexts();
+  void drawSolidCells() const;
+  bool isSolidRun(uint8_t row, uint8_t start, uint8_t end, uint16_t color) const;
+  bool isSolid(uint8_t row, uint8_t column) const;
+  void drawVerticalEdges(uint8_t column, uint16_t offset) const;
+  void drawHorizontalEdges(uint8_t row, uint16_t offset) const;
+};
+
+template <class Table>
+TableRender<Table>::TableRender(TFT_eSPI *tft) : tft(tft), glyphs(nullptr), stepCursor(0), originX(0), originY(0) {
+#ifdef TABLE_STATS
+  stats.reset();
+#endif
+}
+
+//fills are inset inside the outlines, so no fill is painted over by an outline; vertical outline
+//edges run down consecutive rows sharing a color and horizontal edges run across consecutive columns
+//sharing a color. A vertical run still crosses the bottom and top edges between the rows it spans,
+//those two pixels per row boundary are drawn twice. Solid cells (outline == fill) have no visible
+//outline and are merged with their same-colored neighbours into as few rectangles as possible.
+//The result is pixel-identical to drawing each cell on its own.
+template <class Table>
+void TableRender<Table>::draw() {
+  TABLE_STATS_SCOPE(TABLE_STATS_DRAW);
+
+  auto rows = self().getRows();
+  auto columns = self().getColumns();
+
+  tft->startWrite();
+
+  drawSolidCells();
+
+  for (uint8_t row = 0; row < rows; row++) {
+    for (uint8_t column = 0; column < columns; column++) {
+      if (isSolid(row, column))
+        continue;
+
+      auto width = cellWidth(column);
+      auto height = cellHeight(row);
+
+      tft->fillRect(cellX(column) + 1, cellY(row) + 1, width - 2, height - 2, self().getCellFillColor(row, column));
+      TABLE_STATS_RECT(width - 2, height - 2);
+    }
+  }
+
+  for (uint8_t column = 0; column < columns; column++) {
+    drawVerticalEdges(column, 0);
+    if (cellWidth(column) > 1)
+      drawVerticalEdges(column, cellWidth(column) - 1);
+  }
+
+  for (uint8_t row = 0; row < rows; row++) {
+    drawHorizontalEdges(row, 0);
+    if (cellHeight(row) > 1)
+      drawHorizontalEdges(row, cellHeight(row) - 1);
+  }
+
+  drawStoredTexts();
+
+  tft->endWrite();
+
+  clearDirty();
+}
+
+//same output as draw(), but the whole table is sent as one address window and one continuous pixel
+//stream. Each row band is built into a scanline once and pushed for every pixel row it covers.
+template <class Table>
+void TableRender<Table>::pushScanlines(uint16_t *edgeLine, uint16_t *innerLine) {
+  TABLE_STATS_SCOPE(TABLE_STATS_DRAW);
+
+  auto rows = self().getRows();
+  auto columns = self().getColumns();
+  auto width = self().getWidth();
+  auto height = self().getHeight();
+
+#if defined(ESP32_DMA) || defined(RP2040_DMA) || defined(STM32_DMA)
+  //pushPixelsDMA() byte-swaps in place when swapping is on, so the scanlines are built pre-swapped
+  //and reused as they are
+  auto dma = tft->DMA_Enabled;
+  auto swapBytes = tft->getSwapBytes();
+  if (dma)
+    tft->setSwapBytes(false);
+#else
+  auto dma = false;
+#endif
+
+  tft->startWrite();
+  tft->setAddrWindow(cellX(0), cellY(0), width, height);
+  TABLE_STATS_WINDOW();
+
+  for (uint8_t row = 0; row < rows; row++) {
+    if (dma)
+      tft->dmaWait();
+
+    uint16_t offset = 0;
+    for (uint8_t column = 0; column < columns; column++) {
+      auto fillColor = self().getCellFillColor(row, column);
+      auto outlineColor = self().getCellOutlineColor(row, column);
+      auto columnWidth = cellWidth(column);
+
+      if (dma) {
+        fillColor = fillColor << 8 | fillColor >> 8;
+        outlineColor = outlineColor << 8 | outlineColor >> 8;
+      }
+
+      for (uint16_t i = 0; i < columnWidth; i++) {
+        auto isOutline = i == 0 || i == columnWidth - 1;
+        edgeLine[offset + i] = outlineColor;
+        innerLine[offset + i] = isOutline ? outlineColor : fillColor;
+      }
+      offset += columnWidth;
+    }
+
+    auto rowHeight = cellHeight(row);
+    for (uint16_t line = 0; line < rowHeight; line++) {
+      auto scanline = line == 0 || line == rowHeight - 1 ? edgeLine : innerLine;
+      TABLE_STATS_PIXELS(width);
+
+#if defined(ESP32_DMA) || defined(RP2040_DMA) || defined(STM32_DMA)
+      if (dma) {
+        tft->pushPixelsDMA(scanline, width);
+        continue;
+      }
+#endif
+      tft->pushColors(scanline, width, true);
+    }
+  }
+
+#if defined(ESP32_DMA) || defined(RP2040_DMA) || defined(STM32_DMA)
+  if (dma) {
+    tft->dmaWait();
+    tft->setSwapBytes(swapBytes);
+  }
+#endif
+
+  drawStoredTexts();
+
+  tft->endWrite();
+
+  clearDirty();
+}
+
+//repaints only the cells changed since the last draw()/flush(), in a single SPI transaction
+template <class Table>
+void TableRender<Table>::flush() {
+  TABLE_STATS_SCOPE(TABLE_STATS_FLUSH);
+
+  auto rows = self().getRows();
+  auto columns = self().getColumns();
+
+  tft->startWrite();
+
+  for (uint8_t row = 0; row < rows; row++) {
+    for (uint8_t column = 0; column < columns; column++) {
+      if (isDirty(row, column))
+        drawCell(row, column);
+    }
+  }
+
+  tft->endWrite();
+
+  clearDirty();
+}
+
+template <class Table>
+void TableRender<Table>::flushSprite(TFT_eSprite *sprite, uint32_t maxBytes) {
+  TABLE_STATS_SCOPE(TABLE_STATS_FLUSH);
+
+  auto rows = self().getRows();
+  auto columns = self().getColumns();
+  auto &dirtyCells = self().dirtyCells;
+  auto offsets = self().rowAxis().offsets;
+  auto columnOffsets = self().columnAxis().offsets;
+
+  for (uint8_t row = 0; row < rows; row++) {
+    uint8_t column = 0;
+    while (column < columns) {
+      if (!isDirty(row, column)) {
+        column++;
+        continue;
+      }
+
+      //as many dirty cells of the run as fit, the rest of it starts the next band; a cell too large
+      //for maxBytes on its own is drawn directly
+      auto first = column;
+      while (column < columns && isDirty(row, column)
+          && 2UL * (columnOffsets[column + 1] - columnOffsets[first]) * cellHeight(row) <= maxBytes)
+        column++;
+      if (column == first) {
+        tft->startWrite();
+        drawCell(row, column);
+        tft->endWrite();
+        auto index = row * columns + column;
+        dirtyCells[index >> 3] &= ~(1 << (index & 7));
+        column++;
+        continue;
+      }
+      uint8_t last = column - 1;
+
+      //stretch the band down over the rows dirty in the same columns while it fits, so no clean cell
+      //is pushed
+      auto width = columnOffsets[last + 1] - columnOffsets[first];
+      uint8_t lastRow = row;
+      while (lastRow + 1 < rows && isDirtyRun(lastRow + 1, first, last)
+          && 2UL * width * (offsets[lastRow + 2] - offsets[row]) <= maxBytes)
+        lastRow++;
+
+      if (!composeBand(sprite, row, lastRow, first, last)) {
+        tft->startWrite();
+        for (auto cell = first; cell <= last; cell++)
+          drawCell(row, cell);
+        tft->endWrite();
+        lastRow = row;
+      }
+
+      for (auto band = row; band <= lastRow; band++) {
+        for (auto cell = first; cell <= last; cell++) {
+          auto index = band * columns + cell;
+          dirtyCells[index >> 3] &= ~(1 << (index & 7));
+        }
+      }
+    }
+  }
+}
+
+template <class Table>
+bool TableRender<Table>::isDirtyRun(uint8_t row, uint8_t first, uint8_t last) const {
+  for (auto column = first; column <= last; column++) {
+    if (!isDirty(row, column))
+      return false;
+  }
+  return true;
+}
+
+//every cell of the band is drawn into the sprite, with the origin moved so the band starts at 0,0,
+//then the sprite is pushed as one window
+template <class Table>
+bool TableRender<Table>::composeBand(TFT_eSprite *sprite, uint8_t firstRow, uint8_t lastRow, uint8_t firstColumn, uint8_t lastColumn) {
+  auto left = cellX(firstColumn);
+  auto top = cellY(firstRow);
+  auto width = cellX(lastColumn + 1) - left;
+  auto height = cellY(lastRow + 1) - top;
+
+  sprite->setColorDepth(16);
+  if (sprite->createSprite(width, height) == nullptr)
+    return false;
+
+  originX = left;
+  originY = top;
+
+  //only the push reaches the panel
+#ifdef TABLE_STATS
+  auto operation = stats.current;
+  stats.current = TABLE_STATS_OPERATIONS;
+#endif
+
+  //glyphs are pushed to the screen, the sprite gets drawString()
+  auto screen = tft;
+  auto cache = glyphs;
+  tft = sprite;
+  glyphs = nullptr;
+  for (auto row = firstRow; row <= lastRow; row++) {
+    for (auto column = firstColumn; column <= lastColumn; column++)
+      drawCell(row, column);
+  }
+  tft = screen;
+  glyphs = cache;
+
+#ifdef TABLE_STATS
+  stats.current = operation;
+#endif
+
+  originX = 0;
+  originY = 0;
+
+  sprite->pushSprite(left, top);
+  TABLE_STATS_RECT(width, height);
+  sprite->deleteSprite();
+  return true;
+}
+
+template <class Table>
+void TableRender<Table>::beginDraw() {
+  uint16_t cells = self().getRows() * self().getColumns();
+  auto &dirtyCells = self().dirtyCells;
+
+  memset(dirtyCells, 0xFF, cells / 8);
+  if (cells % 8 != 0)
+    dirtyCells[cells / 8] = (1 << (cells % 8)) - 1;
+  stepCursor = 0;
+}
+
+//one lap over the cells from where the previous step stopped, so cells marked dirty behind the cursor
+//while a repaint is under way are picked up by a later step
+template <class Table>
+bool TableRender<Table>::step(uint32_t budgetMicros, uint32_t budgetPixels) {
+  TABLE_STATS_SCOPE(TABLE_STATS_FLUSH);
+
+  auto columns = self().getColumns();
+  uint16_t cells = self().getRows() * columns;
+  auto &dirtyCells = self().dirtyCells;
+  uint32_t start = micros();
+  uint32_t pixels = 0;
+
+  tft->startWrite();
+
+  for (uint16_t checked = 0; checked < cells; checked++) {
+    auto cell = stepCursor;
+    stepCursor = stepCursor + 1 < cells ? stepCursor + 1 : 0;
+
+    if (!(dirtyCells[cell >> 3] & (1 << (cell & 7))))
+      continue;
+
+    if (pixels > 0 && ((budgetMicros != 0 && micros() - start >= budgetMicros)
+        || (budgetPixels != 0 && pixels >= budgetPixels))) {
+      stepCursor = cell;
+      break;
+    }
+
+    uint8_t row = cell / columns;
+    uint8_t column = cell % columns;
+
+    dirtyCells[cell >> 3] &= ~(1 << (cell & 7));
+    drawCell(row, column);
+    pixels += cellWidth(column) * cellHeight(row);
+  }
+
+  tft->endWrite();
+
+  return hasDirtyCells();
+}
+
+template <class Table>
+bool TableRender<Table>::hasDirtyCells() const {
+  auto &dirtyCells = self().dirtyCells;
+
+  for (uint16_t i = 0; i < (self().getRows() * self().getColumns() + 7) / 8; i++) {
+    if (dirtyCells[i] != 0)
+      return true;
+  }
+  return false;
+}
+
+template <class Table>
+void TableRender<Table>::clearDirty() {
+  memset(self().dirtyCells, 0, (self().getRows() * self().getColumns() + 7) / 8);
+}
+
+template <class Table>
+void TableRender<Table>::markDirty(uint8_t row, uint8_t column) {
+  auto index = row * self().getColumns() + column;
+  self().dirtyCells[index >> 3] |= 1 << (index & 7);
+}
+
+template <class Table>
+bool TableRender<Table>::isDirty(uint8_t row, uint8_t column) const {
+  auto index = row * self().getColumns() + column;
+  return self().dirtyCells[index >> 3] & (1 << (index & 7));
+}
+
+template <class Table>
+void TableRender<Table>::drawCell(uint8_t row, uint8_t column) {
+  auto x = cellX(column);
+  auto y = cellY(row);
+  auto width = cellWidth(column);
+  auto height = cellHeight(row);
+
+  tft->fillRect(x + 1, y + 1, width - 2, height - 2, self().getCellFillColor(row, column));
+  tft->drawRect(x, y, width, height, self().getCellOutlineColor(row, column));
+  TABLE_STATS_RECT(width - 2, height - 2);
+  TABLE_STATS_OUTLINE(width, height);
+
+  drawStoredText(row, column);
+}
+
+//horizontal runs of same-colored solid cells first, then each run is stretched over the rows below
+//that hold a run with exactly the same extent and color
+template <class Table>
+void TableRender<Table>::drawSolidCells() const {
+  auto rows = self().getRows();
+  auto columns = self().getColumns();
+
+  for (uint8_t row = 0; row < rows; row++) {
+    uint8_t column = 0;
+    while (column < columns) {
+      if (!isSolid(row, column)) {
+        column++;
+        continue;
+      }
+
+      auto color = self().getCellFillColor(row, column);
+      auto start = column;
+      uint16_t width = 0;
+
+      while (column < columns && isSolid(row, column) && self().getCellFillColor(row, column) == color) {
+        width += cellWidth(column);
+        column++;
+      }
+
+      //already covered by the rectangle started in a row above
+      if (row > 0 && isSolidRun(row - 1, start, column, color))
+        continue;
+
+      uint16_t height = cellHeight(row);
+      for (auto below = row + 1; below < rows && isSolidRun(below, start, column, color); below++)
+        height += cellHeight(below);
+
+      tft->fillRect(cellX(start), cellY(row), width, height, color);
+      TABLE_STATS_RECT(width, height);
+    }
+  }
+}
+
+//true if [start, end) is a maximal run of solid cells of the given color in this row
+template <class Table>
+bool TableRender<Table>::isSolidRun(uint8_t row, uint8_t start, uint8_t end, uint16_t color) const {
+  if (start > 0 && isSolid(row, start - 1) && self().getCellFillColor(row, start - 1) == color)
+    return false;
+  if (end < self().getColumns() && isSolid(row, end) && self().getCellFillColor(row, end) == color)
+    return false;
+
+  for (auto column = start; column < end; column++) {
+    if (!isSolid(row, column) || self().getCellFillColor(row, column) != color)
+      return false;
+  }
+
+  return true;
+}
+
+template <class Table>
+bool TableRender<Table>::isSolid(uint8_t row, uint8_t column) const {
+  return self().getCellFillColor(row, column) == self().getCellOutlineColor(row, column);
+}
+
+//one line per run of vertically adjacent cells sharing an outline color, offset is the edge's x inside the column
+template <class Table>
+void TableRender<Table>::drawVerticalEdges(uint8_t column, uint16_t offset) const {
+  auto rows = self().getRows();
+  auto x = cellX(column) + offset;
+
+  uint8_t row = 0;
+  while (row < rows) {
+    if (isSolid(row, column)) {
+      row++;
+      continue;
+    }
+
+    auto color = self().getCellOutlineColor(row, column);
+    auto y = cellY(row);
+    uint16_t length = 0;
+
+    while (row < rows && !isSolid(row, column) && self().getCellOutlineColor(row, column) == color) {
+      length += cellHeight(row);
+      row++;
+    }
+
+    //the first and last pixel of the run are covered by the horizontal edges
+    tft->drawFastVLine(x, y + 1, length - 2, color);
+    TABLE_STATS_LINE(length - 2);
+  }
+}
+
+//one line per run of horizontally adjacent cells sharing an outline color, offset is the edge's y inside the row
+template <class Table>
+void TableRender<Table>::drawHorizontalEdges(uint8_t row, uint16_t offset) const {
+  auto columns = self().getColumns();
+  auto y = cellY(row) + offset;
+
+  uint8_t column = 0;
+  while (column < columns) {
+    if (isSolid(row, column)) {
+      column++;
+      continue;
+    }
+
+    auto color = self().getCellOutlineColor(row, column);
+    auto x = cellX(column);
+    uint16_t length = 0;
+
+    while (column < columns && !isSolid(row, column) && self().getCellOutlineColor(row, column) == color) {
+      length += cellWidth(column);
+      column++;
+    }
+
+    tft->drawFastHLine(x, y, length, color);
+    TABLE_STATS_LINE(length);
+  }
+}
+
+template <class Table>
+void TableRender<Table>::eraseCell(uint8_t row, uint8_t column) {
+  TABLE_STATS_SCOPE(TABLE_STATS_ERASE_CELL);
+
+  auto width = cellWidth(column);
+  auto height = cellHeight(row);
+
+  tft->fillRect(cellX(column) + 1, cellY(row) + 1, width - 2, height - 2, self().getCellFillColor(row, column));
+  TABLE_STATS_RECT(width - 2, height - 2);
+
+  auto texts = self().storedTexts();
+  if (texts != nullptr) {
+    texts[row * self().getColumns() + column].text[0] = '\0';
+    texts[row * self().getColumns() + column].width = 0;
+  }
+}
+
+template <class Table>
+void TableRender<Table>::drawCellOutline(uint8_t row, uint8_t column) const {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_OUTLINE);
+
+  auto width = cellWidth(column);
+  auto height = cellHeight(row);
+
+  tft->drawRect(cellX(column), cellY(row), width, height, self().getCellOutlineColor(row, column));
+  TABLE_STATS_OUTLINE(width, height);
+}
+
+template <class Table>
+void TableRender<Table>::drawCellText(uint8_t row, uint8_t column, const char *text, uint16_t clr) const {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+
+  tft->setTextColor(clr);
+
+  auto x = cellX(column) + cellWidth(column) / 2;
+  auto y = cellY(row) + cellHeight(row) / 2;
+
+  tft->drawString(text, x, y);
+  TABLE_STATS_TEXT(text, tft->textWidth(text));
+
+  tft->setTextColor(ILI9486_WHITE);
+}
+
+template <class Table>
+void TableRender<Table>::drawCellText(uint8_t row, uint8_t column, const char *text, size_t length, uint16_t clr) const {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+  tableFormatText(textBuffer, sizeof(textBuffer), text, length);
+  drawCellText(row, column, textBuffer, clr);
+}
+
+template <class Table>
+void TableRender<Table>::drawCellText(uint8_t row, uint8_t column, const String &text, uint16_t clr) const {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+  drawCellText(row, column, text.c_str(), clr);
+}
+
+template <class Table>
+void TableRender<Table>::drawCellText(uint8_t row, uint8_t column, float value, uint8_t decimals, uint16_t clr) const {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+  tableFormatFloat(textBuffer, sizeof(textBuffer), value, decimals);
+  drawCellText(row, column, textBuffer, clr);
+}
+
+template <class Table>
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type
+TableRender<Table>::drawCellText(uint8_t row, uint8_t column, T value, uint16_t clr) const {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+  tableFormatInteger(textBuffer, sizeof(textBuffer), value);
+  drawCellText(row, column, textBuffer, clr);
+}
+
+//redraws only what changed: the new text is drawn with the cell's fill as its background and padded
+//to the width of the previous text, so the old pixels it doesn't cover are cleared in the same pass
+//and the cell is never blanked in between. Unchanged text is skipped.
+template <class Table>
+void TableRender<Table>::updateCellText(uint8_t row, uint8_t column, const char *text, uint16_t clr) {
+  static_assert(Table::storesTexts, "updateCellText() needs a table that stores texts");
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+
+  auto texts = self().acquireTexts();
+  if (texts == nullptr)
+    return;
+
+  auto &cell = texts[row * self().getColumns() + column];
+  char previous[TABLE_CELL_TEXT_SIZE];
+  auto previousColor = cell.color;
+  if (glyphs != nullptr)
+    memcpy(previous, cell.text, sizeof(previous));
+  if (!tableStoreText(cell, text, clr))
+    return;
+
+  if (glyphs != nullptr) {
+    tft->startWrite();
+    auto drawn = drawGlyphs(row, column, cell, previousColor == clr ? previous : nullptr, cell.width);
+    tft->endWrite();
+    if (drawn)
+      return;
+  }
+
+  auto x = cellX(column) + cellWidth(column) / 2;
+  auto y = cellY(row) + cellHeight(row) / 2;
+
+  tft->setTextColor(clr, self().getCellFillColor(row, column));
+  tft->setTextPadding(cell.width);
+  cell.width = tft->drawString(cell.text, x, y);
+  TABLE_STATS_TEXT(cell.text, cell.width);
+  tft->setTextPadding(0);
+}
+
+template <class Table>
+void TableRender<Table>::updateCellText(uint8_t row, uint8_t column, const char *text, size_t length, uint16_t clr) {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+  tableFormatText(textBuffer, sizeof(textBuffer), text, length);
+  updateCellText(row, column, textBuffer, clr);
+}
+
+template <class Table>
+void TableRender<Table>::updateCellText(uint8_t row, uint8_t column, const String &text, uint16_t clr) {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+  updateCellText(row, column, text.c_str(), clr);
+}
+
+template <class Table>
+void TableRender<Table>::updateCellText(uint8_t row, uint8_t column, float value, uint8_t decimals, uint16_t clr) {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+  tableFormatFloat(textBuffer, sizeof(textBuffer), value, decimals);
+  updateCellText(row, column, textBuffer, clr);
+}
+
+template <class Table>
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type
+TableRender<Table>::updateCellText(uint8_t row, uint8_t column, T value, uint16_t clr) {
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+  tableFormatInteger(textBuffer, sizeof(textBuffer), value);
+  updateCellText(row, column, textBuffer, clr);
+}
+
+template <class Table>
+void TableRender<Table>::updateCells(TableCellUpdate *updates, uint16_t count) {
+  static_assert(Table::storesTexts, "updateCells() needs a table that stores texts");
+  TABLE_STATS_SCOPE(TABLE_STATS_CELL_TEXT);
+
+  auto texts = self().acquireTexts();
+  if (texts == nullptr)
+    return;
+
+  tableSortUpdates(updates, count);
+
+  //text colors are only sent when they differ from the previous drawn update
+  uint32_t textColors = 0xFFFFFFFF;
+
+  tft->startWrite();
+  for (uint16_t i = 0; i < count; i++) {
+    auto &update = updates[i];
+
+    //only the last update of a cell counts
+    if (i + 1 < count && updates[i + 1].row == update.row && updates[i + 1].column == update.column)
+      continue;
+
+    auto &cell = texts[update.row * self().getColumns() + update.column];
+    char previous[TABLE_CELL_TEXT_SIZE];
+    auto previousColor = cell.color;
+    if (glyphs != nullptr)
+      memcpy(previous, cell.text, sizeof(previous));
+    if (!tableStoreText(cell, update.text, update.color))
+      continue;
+
+    if (glyphs != nullptr
+        && drawGlyphs(update.row, update.column, cell, previousColor == update.color ? previous : nullptr, cell.width))
+      continue;
+
+    auto background = self().getCellFillColor(update.row, update.column);
+    if (textColors != ((uint32_t)update.color << 16 | background)) {
+      textColors = (uint32_t)update.color << 16 | background;
+      tft->setTextColor(update.color, background);
+    }
+
+    tft->setTextPadding(cell.width);
+    cell.width = tft->drawString(cell.text, cellX(update.column) + cellWidth(update.column) / 2,
+      cellY(update.row) + cellHeight(update.row) / 2);
+    TABLE_STATS_TEXT(cell.text, cell.width);
+  }
+  tft->setTextPadding(0);
+  tft->endWrite();
+}
+
+template <class Table>
+void TableRender<Table>::applyCells(TableCellUpdate *updates, uint16_t count) {
+  static_assert(Table::storesTexts, "applyCells() needs a table that stores texts");
+
+  if (!hasDirtyCells()) {
+    if (count > 0)
+      updateCells(updates, count);
+    return;
+  }
+
+  auto texts = count > 0 ? self().acquireTexts() : nullptr;
+  uint16_t kept = 0;
+  if (texts != nullptr) {
+    tableSortUpdates(updates, count);
+    for (uint16_t i = 0; i < count; i++) {
+      auto &update = updates[i];
+      if (i + 1 < count && updates[i + 1].row == update.row && updates[i + 1].column == update.column)
+        continue;
+
+      if (isDirty(update.row, update.column))
+        tableStoreText(texts[update.row * self().getColumns() + update.column], update.text, update.color);
+      else
+        updates[kept++] = update;
+    }
+  }
+
+  flush();
+  if (kept > 0)
+    updateCells(updates, kept);
+}
+
+template <class Table>
+void TableRender<Table>::setGlyphCache(TableGlyphCache *cache) {
+  glyphs = cache;
+}
+
+//previous is the text on screen when it was drawn in the same color, width its width
+template <class Table>
+bool TableRender<Table>::drawGlyphs(uint8_t row, uint8_t column, TableCellText &cell, const char *previous, uint16_t width) {
+  auto x = cellX(column) + cellWidth(column) / 2;
+  auto y = cellY(row) + cellHeight(row) / 2;
+
+  uint32_t pixels = 0;
+  if (!glyphs->draw(x, y, cell.text, previous, cell.color, self().getCellFillColor(row, column), width, pixels))
+    return false;
+
+  cell.width = width;
+  TABLE_STATS_PIXELS(pixels);
+  return true;
+}
+
+//repaints the text remembered by updateCellText() on top of a freshly filled cell
+template <class Table>
+void TableRender<Table>::drawStoredText(uint8_t row, uint8_t column) {
+  auto texts = self().storedTexts();
+  if (texts == nullptr)
+    return;
+
+  auto &cell = texts[row * self().getColumns() + column];
+  if (cell.text[0] == '\0')
+    return;
+  if (glyphs != nullptr && drawGlyphs(row, column, cell, nullptr, 0))
+    return;
+
+  auto x = cellX(column) + cellWidth(column) / 2;
+  auto y = cellY(row) + cellHeight(row) / 2;
+
+  tft->setTextColor(cell.color, self().getCellFillColor(row, column));
+  cell.width = tft->drawString(cell.text, x, y);
+  TABLE_STATS_TEXT(cell.text, cell.width);
+}
+
+template <class Table>
+void TableRender<Table>::drawStoredTexts() {
+  if (self().storedTexts() == nullptr)
+    return;
+
+  for (uint8_t row = 0; row < self().getRows(); row++) {
+    for (uint8_t column = 0; column < self().getColumns(); column++)
+      drawStoredText(row, column);
+  }
+}
+
+template <class Table>
+uint16_t TableRender<Table>::cellAt(uint16_t x, uint16_t y) const {
+  uint8_t row, column;
+  return cellAt(x, y, row, column) ? row * self().getColumns() + column : TABLE_NO_CELL;
+}
+
+template <class Table>
+bool TableRender<Table>::cellAt(uint16_t x, uint16_t y, uint8_t &row, uint8_t &column) const {
+  column = tableSpanAt(self().columnAxis().offsets, self().getColumns(), x);
+  row = tableSpanAt(self().rowAxis().offsets, self().getRows(), y);
+  return column < self().getColumns() && row < self().getRows();
+}
+
+template <class Table>
+void TableRender<Table>::cellsAt(const uint16_t *xs, const uint16_t *ys, uint16_t *cells, uint8_t count) const {
+  for (uint8_t i = 0; i < count; i++)
+    cells[i] = cellAt(xs[i], ys[i]);
+}
+
+template <class Table>
+uint16_t TableRender<Table>::getRowY(uint8_t row) const {
+  return self().rowAxis().offsets[row];
+}
+
+#ifdef TABLE_STATS
+template <class Table>
+TableStats TableRender<Table>::getStats() const {
+  return stats;
+}
+
+template <class Table>
+void TableRender<Table>::resetStats() {
+  stats.reset();
+}
+#endif
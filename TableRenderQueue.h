@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "TableText.h"
+
+//cell mutations handed from the application to a render task, independent of TFT_eSPI so the queue
+//also builds on a desktop (e.g. against std::thread) for benchmarking
+
+enum TableCommandType : uint8_t {
+  TABLE_COMMAND_FILL,
+  TABLE_COMMAND_OUTLINE,
+  TABLE_COMMAND_TEXT
+};
+
+struct TableCellCommand {
+  uint8_t type;
+  uint8_t row;
+  uint8_t column;
+  uint16_t color;
+  char text[TABLE_CELL_TEXT_SIZE];
+};
+
+//lock-free single producer/single consumer ring, Capacity must be a power of two. Only the producer
+//moves head and only the consumer moves tail, so each side needs nothing but its own index and an
+//acquire of the other's.
+template <uint16_t Capacity>
+class TableRenderQueue {
+  static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+  TableRenderQueue() : head(0), tail(0) {}
+
+  //producer side, false when the queue is full
+  bool push(const TableCellCommand &command) {
+    auto position = head.load(std::memory_order_relaxed);
+    if ((uint16_t)(position - tail.load(std::memory_order_acquire)) == Capacity)
+      return false;
+
+    commands[position & (Capacity - 1)] = command;
+    head.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  //consumer side, false when the queue is empty
+  bool pop(TableCellCommand &command) {
+    auto position = tail.load(std::memory_order_relaxed);
+    if (position == head.load(std::memory_order_acquire))
+      return false;
+
+    command = commands[position & (Capacity - 1)];
+    tail.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+private:
+  TableCellCommand commands[Capacity];
+  std::atomic<uint16_t> head;
+  std::atomic<uint16_t> tail;
+};
+
+//sorts commands into raster order and keeps only the last command of each type per cell, returns the
+//remaining count. Stable insertion sort: batches are small and nothing is allocated
+inline uint16_t tableCoalesceCommands(TableCellCommand *commands, uint16_t count) {
+  auto key = [](const TableCellCommand &command) {
+    return (uint32_t)command.row << 16 | (uint32_t)command.column << 8 | command.type;
+  };
+
+  for (uint16_t i = 1; i < count; i++) {
+    auto command = commands[i];
+    auto j = i;
+    while (j > 0 && key(commands[j - 1]) > key(command)) {
+      commands[j] = commands[j - 1];
+      j--;
+    }
+    commands[j] = command;
+  }
+
+  uint16_t kept = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    if (i + 1 < count && key(commands[i + 1]) == key(commands[i]))
+      continue;
+    if (kept != i)
+      commands[kept] = commands[i];
+    kept++;
+  }
+  return kept;
+}
@@ -0,0 +1,163 @@
+#pragma once
+
+#ifdef ESP32
+#include <Arduino.h>
+#endif
+
+#include "TableRenderQueue.h"
+
+//moves rendering off the application: the application thread calls the setters below, which only
+//copy a command into a TableRenderQueue, and render() drains the queue on another thread or core,
+//coalesces repeated updates to the same cell and applies them to the table in one applyCells().
+//On ESP32 begin() runs render() in its own FreeRTOS task; anywhere else render() can
+//be called from a thread of your own.
+template <class Table, uint16_t Capacity = 64, uint16_t BatchSize = 32>
+class TableRenderTask {
+public:
+  TableRenderTask(Table *table) : table(table) {
+#ifdef ESP32
+    task = nullptr;
+    running = false;
+    stopped = true;
+#endif
+  }
+#ifdef ESP32
+  ~TableRenderTask() { end(); }
+#endif
+
+  //producer side, false when the queue is full
+  bool setCellFillColor(uint8_t row, uint8_t column, uint16_t color);
+  bool setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color);
+  //text is copied (and cut to TABLE_CELL_TEXT_SIZE - 1 characters)
+  bool updateCellText(uint8_t row, uint8_t column, const char *text, uint16_t color);
+
+  //consumer side: applies up to BatchSize queued commands, returns how many were left after coalescing
+  uint16_t render();
+
+#ifdef ESP32
+  //render task pinned to a core, sleeps a tick whenever the queue is empty; false when it couldn't be
+  //created or is already running
+  bool begin(uint8_t core = 0, uint8_t priority = 1, uint32_t stackSize = 4096);
+  //asks the task to finish its current batch and delete itself, returns once it no longer touches the
+  //table. Commands still queued stay queued for render() or a later begin()
+  void end();
+#endif
+
+private:
+  Table *table;
+  TableRenderQueue<Capacity> queue;
+
+  TableCellCommand batch[BatchSize];
+  TableCellUpdate updates[BatchSize];
+
+  bool push(uint8_t type, uint8_t row, uint8_t column, uint16_t color, const char *text);
+
+#ifdef ESP32
+  TaskHandle_t task;
+  //cleared by end(), the task checks it between batches and sets stopped as its last access to this
+  std::atomic<bool> running;
+  std::atomic<bool> stopped;
+
+  static void run(void *parameter);
+#endif
+};
+
+template <class Table, uint16_t Capacity, uint16_t BatchSize>
+bool TableRenderTask<Table, Capacity, BatchSize>::setCellFillColor(uint8_t row, uint8_t column, uint16_t color) {
+  return push(TABLE_COMMAND_FILL, row, column, color, nullptr);
+}
+
+template <class Table, uint16_t Capacity, uint16_t BatchSize>
+bool TableRenderTask<Table, Capacity, BatchSize>::setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color) {
+  return push(TABLE_COMMAND_OUTLINE, row, column, color, nullptr);
+}
+
+template <class Table, uint16_t Capacity, uint16_t BatchSize>
+bool TableRenderTask<Table, Capacity, BatchSize>::updateCellText(uint8_t row, uint8_t column, const char *text, uint16_t color) {
+  return push(TABLE_COMMAND_TEXT, row, column, color, text);
+}
+
+template <class Table, uint16_t Capacity, uint16_t BatchSize>
+bool TableRenderTask<Table, Capacity, BatchSize>::push(uint8_t type, uint8_t row, uint8_t column, uint16_t color, const char *text) {
+  TableCellCommand command;
+  command.type = type;
+  command.row = row;
+  command.column = column;
+  command.color = color;
+  if (text != nullptr)
+    tableFormatText(command.text, sizeof(command.text), text, sizeof(command.text));
+  else
+    command.text[0] = '\0';
+
+  return queue.push(command);
+}
+
+template <class Table, uint16_t Capacity, uint16_t BatchSize>
+uint16_t TableRenderTask<Table, Capacity, BatchSize>::render() {
+  uint16_t count = 0;
+  while (count < BatchSize && queue.pop(batch[count]))
+    count++;
+  if (count == 0)
+    return 0;
+
+  count = tableCoalesceCommands(batch, count);
+
+  uint16_t texts = 0;
+  for (uint16_t i = 0; i < count; i++) {
+    auto &command = batch[i];
+    if (command.type == TABLE_COMMAND_TEXT) {
+      updates[texts++] = {command.row, command.column, command.text, command.color};
+      continue;
+    }
+
+    if (command.type == TABLE_COMMAND_FILL)
+      table->setCellFillColor(command.row, command.column, command.color);
+    else
+      table->setCellOutlineColor(command.row, command.column, command.color);
+  }
+
+  table->applyCells(updates, texts);
+
+  return count;
+}
+
+#ifdef ESP32
+template <class Table, uint16_t Capacity, uint16_t BatchSize>
+bool TableRenderTask<Table, Capacity, BatchSize>::begin(uint8_t core, uint8_t priority, uint32_t stackSize) {
+  if (task != nullptr)
+    return false;
+
+  running = true;
+  stopped = false;
+  if (xTaskCreatePinnedToCore(run, "table", stackSize, this, priority, &task, core) == pdPASS)
+    return true;
+
+  running = false;
+  stopped = true;
+  task = nullptr;
+  return false;
+}
+
+//the task deletes itself instead of being deleted from here, so it never dies inside a bus transaction
+template <class Table, uint16_t Capacity, uint16_t BatchSize>
+void TableRenderTask<Table, Capacity, BatchSize>::end() {
+  if (task == nullptr)
+    return;
+
+  running = false;
+  while (!stopped)
+    vTaskDelay(1);
+  task = nullptr;
+}
+
+template <class Table, uint16_t Capacity, uint16_t BatchSize>
+void TableRenderTask<Table, Capacity, BatchSize>::run(void *parameter) {
+  auto task = static_cast<TableRenderTask *>(parameter);
+  while (task->running) {
+    if (task->render() == 0)
+      vTaskDelay(1);
+  }
+  task->stopped = true;
+  vTaskDelete(nullptr);
+}
+#endif
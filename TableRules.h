@@ -0,0 +1,171 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "TableText.h"
+
+//colors of a cell while its value lies in a band
+struct TableStyle {
+    uint16_t fill;
+    uint16_t outline;
+    uint16_t text;
+};
+
+//a band takes the values below upTo that no earlier band took, the last one also everything above
+struct TableBand {
+    float upTo;
+    TableStyle style;
+};
+
+//conditional formatting: values are pushed as numbers, printed into their cell and styled by the band
+//they fall in, from per column bands or per cell overrides. The band each cell shows is remembered, so
+//colors are only set, and the cell only marked dirty, when a value crosses into another band, and text
+//is only redrawn when the printed value changes. A batch is applied with the table's applyCells(), so
+//a restyled cell is repainted once, with its new text.
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules = 4>
+class TableRules {
+public:
+    //textColor is used for cells without bands
+    TableRules(Table* table, uint16_t textColor);
+
+    //bands ordered by upTo, kept by pointer (e.g. static const arrays); count 0 removes the rule
+    void setColumnBands(uint8_t column, const TableBand* bands, uint8_t count, uint8_t decimals = 2);
+    //overrides the column's bands for one cell, false when all CellRules slots are taken
+    bool setCellBands(uint8_t row, uint8_t column, const TableBand* bands, uint8_t count, uint8_t decimals = 2);
+
+    //table must be generated and drawn first
+    void setValue(uint8_t row, uint8_t column, float value);
+    //count values for column from firstRow on, evaluated and applied as one batch
+    void setColumn(uint8_t column, const float* values, uint8_t count, uint8_t firstRow = 0);
+
+    //index of the band the cell is styled by, -1 before its first value or without bands
+    int8_t getBand(uint8_t row, uint8_t column) const;
+
+private:
+    struct Rule {
+        const TableBand* bands;
+        uint8_t count;
+        uint8_t decimals;
+    };
+
+    struct CellRule {
+        uint8_t row;
+        uint8_t column;
+        Rule rule;
+    };
+
+    Table* table;
+    uint16_t textColor;
+
+    Rule columnRules[Columns];
+    CellRule cellRules[CellRules];
+    uint8_t cellRuleCount;
+
+    int8_t bands[Rows][Columns];
+
+    char texts[Rows][TABLE_CELL_TEXT_SIZE];
+    TableCellUpdate updates[Rows];
+
+    const Rule& ruleOf(uint8_t row, uint8_t column) const;
+    static uint8_t bandOf(const Rule& rule, float value);
+    void forget(uint8_t row, uint8_t column);
+};
+
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+TableRules<Table, Rows, Columns, CellRules>::TableRules(Table* table, uint16_t textColor) :
+    table(table), textColor(textColor), columnRules{}, cellRuleCount(0) {
+    for (uint8_t row = 0; row < Rows; row++) {
+        for (uint8_t column = 0; column < Columns; column++)
+            bands[row][column] = -1;
+    }
+    for (uint8_t column = 0; column < Columns; column++)
+        columnRules[column].decimals = 2;
+}
+
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+void TableRules<Table, Rows, Columns, CellRules>::setColumnBands(uint8_t column, const TableBand* bands, uint8_t count, uint8_t decimals) {
+    columnRules[column] = {bands, count, decimals};
+    for (uint8_t row = 0; row < Rows; row++)
+        forget(row, column);
+}
+
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+bool TableRules<Table, Rows, Columns, CellRules>::setCellBands(uint8_t row, uint8_t column, const TableBand* bands, uint8_t count, uint8_t decimals) {
+    uint8_t i = 0;
+    while (i < cellRuleCount && (cellRules[i].row != row || cellRules[i].column != column))
+        i++;
+
+    if (i == cellRuleCount) {
+        if (cellRuleCount == CellRules)
+            return false;
+        cellRuleCount++;
+    }
+
+    cellRules[i] = {row, column, {bands, count, decimals}};
+    forget(row, column);
+    return true;
+}
+
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+void TableRules<Table, Rows, Columns, CellRules>::setValue(uint8_t row, uint8_t column, float value) {
+    setColumn(column, &value, 1, row);
+}
+
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+void TableRules<Table, Rows, Columns, CellRules>::setColumn(uint8_t column, const float* values, uint8_t count, uint8_t firstRow) {
+    uint8_t updateCount = 0;
+
+    for (uint8_t i = 0; i < count && firstRow + i < Rows; i++) {
+        uint8_t row = firstRow + i;
+        auto& rule = ruleOf(row, column);
+        auto color = textColor;
+
+        if (rule.count > 0) {
+            auto band = bandOf(rule, values[i]);
+            auto& style = rule.bands[band].style;
+            color = style.text;
+
+            if (bands[row][column] != band) {
+                bands[row][column] = band;
+                table->setCellFillColor(row, column, style.fill);
+                table->setCellOutlineColor(row, column, style.outline);
+            }
+        }
+
+        //updateCells() skips texts that didn't change
+        tableFormatFloat(texts[updateCount], TABLE_CELL_TEXT_SIZE, values[i], rule.decimals);
+        updates[updateCount] = {row, column, texts[updateCount], color};
+        updateCount++;
+    }
+
+    table->applyCells(updates, updateCount);
+}
+
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+int8_t TableRules<Table, Rows, Columns, CellRules>::getBand(uint8_t row, uint8_t column) const {
+    return bands[row][column];
+}
+
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+const typename TableRules<Table, Rows, Columns, CellRules>::Rule& TableRules<Table, Rows, Columns, CellRules>::ruleOf(uint8_t row, uint8_t column) const {
+    for (uint8_t i = 0; i < cellRuleCount; i++) {
+        if (cellRules[i].row == row && cellRules[i].column == column)
+            return cellRules[i].rule;
+    }
+    return columnRules[column];
+}
+
+//bands are few, a linear scan beats a binary search
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+uint8_t TableRules<Table, Rows, Columns, CellRules>::bandOf(const Rule& rule, float value) {
+    uint8_t band = 0;
+    while (band + 1 < rule.count && !(value < rule.bands[band].upTo))
+        band++;
+    return band;
+}
+
+//the next value restyles the cell even if it stays in the same band index
+template <class Table, uint8_t Rows, uint8_t Columns, uint8_t CellRules>
+void TableRules<Table, Rows, Columns, CellRules>::forget(uint8_t row, uint8_t column) {
+    bands[row][column] = -1;
+}
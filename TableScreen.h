@@ -0,0 +1,204 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+
+//several TableHeap/TableStack instances sharing one TFT_eSPI, rendered against one time budget per
+//frame. Tables are kept ordered by priority, higher first, then top to bottom and left to right, so a
+//frame writes the screen in a fixed order: the high priority tables are always served first and get
+//as much of the budget as they need, tables of equal priority split what is left evenly. Every table
+//resumes where its last step() stopped, and every dirty table repaints at least one cell per frame,
+//even after the budget is spent, so a busy background table is never starved completely; a frame can
+//overrun its budget by one cell per table, and no table delays the ones above it by more than one cell.
+template <uint8_t MaxTables>
+class TableScreen {
+public:
+  TableScreen() : count(0) {}
+
+  //tables must be generated and drawn (or beginDraw()n) first, false when the screen is full
+  template <class Table>
+  bool add(Table *table, uint8_t priority = 0);
+  //false when the table was not added
+  bool remove(const void *table);
+  bool setPriority(const void *table, uint8_t priority);
+
+  //beginDraw() on every table, the next frames then repaint the whole screen
+  void beginDraw();
+  //repaints dirty cells of all tables for about budgetMicros (0 = no limit) plus at most one cell per
+  //table served after it ran out, returns true while cells remain
+  bool frame(uint32_t budgetMicros);
+  bool hasDirtyCells() const;
+
+  uint8_t getCount() const;
+
+private:
+  struct Entry {
+    void *table;
+    uint16_t x;
+    uint16_t y;
+    uint8_t priority;
+    bool (*step)(void *table, uint32_t budgetMicros);
+    bool (*dirty)(const void *table);
+    void (*begin)(void *table);
+  };
+
+  Entry entries[MaxTables];
+  uint8_t count;
+
+  int16_t indexOf(const void *table) const;
+  void insert(const Entry &entry);
+  static bool before(const Entry &a, const Entry &b);
+
+  template <class Table>
+  static bool stepTable(void *table, uint32_t budgetMicros);
+  template <class Table>
+  static bool dirtyTable(const void *table);
+  template <class Table>
+  static void beginTable(void *table);
+};
+
+template <uint8_t MaxTables>
+template <class Table>
+bool TableScreen<MaxTables>::add(Table *table, uint8_t priority) {
+  if (count == MaxTables || indexOf(table) >= 0)
+    return false;
+
+  Entry entry;
+  entry.table = table;
+  entry.x = table->getX();
+  entry.y = table->getY();
+  entry.priority = priority;
+  entry.step = stepTable<Table>;
+  entry.dirty = dirtyTable<Table>;
+  entry.begin = beginTable<Table>;
+  insert(entry);
+  return true;
+}
+
+template <uint8_t MaxTables>
+bool TableScreen<MaxTables>::remove(const void *table) {
+  auto index = indexOf(table);
+  if (index < 0)
+    return false;
+
+  for (auto i = index; i + 1 < count; i++)
+    entries[i] = entries[i + 1];
+  count--;
+  return true;
+}
+
+template <uint8_t MaxTables>
+bool TableScreen<MaxTables>::setPriority(const void *table, uint8_t priority) {
+  auto index = indexOf(table);
+  if (index < 0)
+    return false;
+
+  auto entry = entries[index];
+  entry.priority = priority;
+  remove(table);
+  insert(entry);
+  return true;
+}
+
+template <uint8_t MaxTables>
+void TableScreen<MaxTables>::beginDraw() {
+  for (uint8_t i = 0; i < count; i++)
+    entries[i].begin(entries[i].table);
+}
+
+//a table's share is what is left of the budget divided by the tables of its priority not served yet,
+//so time a table doesn't need passes on to the next one. Once the budget is spent the remaining tables
+//still get the smallest share, for which step() draws a single cell
+template <uint8_t MaxTables>
+bool TableScreen<MaxTables>::frame(uint32_t budgetMicros) {
+  uint32_t start = micros();
+  bool remaining = false;
+
+  for (uint8_t first = 0; first < count;) {
+    uint8_t end = first + 1;
+    while (end < count && entries[end].priority == entries[first].priority)
+      end++;
+
+    for (auto i = first; i < end; i++) {
+      auto &entry = entries[i];
+      if (!entry.dirty(entry.table))
+        continue;
+
+      uint32_t share = 0;
+      if (budgetMicros != 0) {
+        uint32_t elapsed = micros() - start;
+        share = elapsed < budgetMicros ? (budgetMicros - elapsed) / (end - i) : 0;
+        if (share == 0)
+          share = 1;
+      }
+
+      if (entry.step(entry.table, share))
+        remaining = true;
+    }
+
+    first = end;
+  }
+
+  return remaining;
+}
+
+template <uint8_t MaxTables>
+bool TableScreen<MaxTables>::hasDirtyCells() const {
+  for (uint8_t i = 0; i < count; i++) {
+    if (entries[i].dirty(entries[i].table))
+      return true;
+  }
+  return false;
+}
+
+template <uint8_t MaxTables>
+uint8_t TableScreen<MaxTables>::getCount() const {
+  return count;
+}
+
+template <uint8_t MaxTables>
+int16_t TableScreen<MaxTables>::indexOf(const void *table) const {
+  for (uint8_t i = 0; i < count; i++) {
+    if (entries[i].table == table)
+      return i;
+  }
+  return -1;
+}
+
+template <uint8_t MaxTables>
+void TableScreen<MaxTables>::insert(const Entry &entry) {
+  auto i = count;
+  while (i > 0 && before(entry, entries[i - 1])) {
+    entries[i] = entries[i - 1];
+    i--;
+  }
+  entries[i] = entry;
+  count++;
+}
+
+template <uint8_t MaxTables>
+bool TableScreen<MaxTables>::before(const Entry &a, const Entry &b) {
+  if (a.priority != b.priority)
+    return a.priority > b.priority;
+  if (a.y != b.y)
+    return a.y < b.y;
+  return a.x < b.x;
+}
+
+template <uint8_t MaxTables>
+template <class Table>
+bool TableScreen<MaxTables>::stepTable(void *table, uint32_t budgetMicros) {
+  return static_cast<Table *>(table)->step(budgetMicros);
+}
+
+template <uint8_t MaxTables>
+template <class Table>
+bool TableScreen<MaxTables>::dirtyTable(const void *table) {
+  return static_cast<const Table *>(table)->hasDirtyCells();
+}
+
+template <uint8_t MaxTables>
+template <class Table>
+void TableScreen<MaxTables>::beginTable(void *table) {
+  static_cast<Table *>(table)->beginDraw();
+}
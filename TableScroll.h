@@ -0,0 +1,227 @@
+#pragma once
+
+#include <SPI.h>
+#include <TFT_eSPI.h>
+
+//controllers with the MIPI vertical scrolling commands (VSCRDEF 0x33, VSCRSADD 0x37)
+#if !defined(TABLE_HARDWARE_SCROLL) && (defined(ILI9341_DRIVER) || defined(ILI9341_2_DRIVER) || defined(ILI9486_DRIVER) \
+    || defined(ILI9488_DRIVER) || defined(ST7789_DRIVER) || defined(ST7796_DRIVER))
+#define TABLE_HARDWARE_SCROLL
+#endif
+
+//text of one cell of a logical row, nullptr shows an empty cell
+typedef const char* (*TableRowSource)(uint32_t row, uint8_t column, void* context);
+
+//turns a TableHeap or a TableStack with Texts into a viewport over any number of logical rows supplied by source.
+//The table's rows are a ring of slots: with hardware scrolling logical row r always lives in slot
+//r % rows and scrolling only moves the controller's scroll start, so a step repaints just the rows it
+//exposes. Hardware scrolling is used on the controllers above in rotation 0, when the table spans the
+//screen's full width; otherwise the viewport's rows are rewritten in place, which still only repaints
+//the cells whose text changed.
+template <class Table>
+class TableScroll {
+public:
+    TableScroll(TFT_eSPI* tft, Table* table, TableRowSource source, void* context, uint32_t rowCount, uint16_t textColor);
+
+    //table must be generated first; also redefines the scrolling area, so call it again after the
+    //table's geometry changes
+    void draw();
+    //for sources that grow or shrink, follow with scrollTo() to keep showing the newest rows
+    void setRowCount(uint32_t count);
+    //grows the source to count rows and keeps the last ones in view, painting only rows that are new
+    //or come into view
+    void follow(uint32_t count);
+    //refetches the visible rows from the source, repainting only cells whose text changed
+    void refresh();
+
+    //clamped so the viewport stays filled
+    void scrollTo(uint32_t row);
+    void scrollBy(int32_t rows);
+
+    //restores the normal (unscrolled) screen, call before drawing something else in the table's area
+    void end();
+
+    uint32_t getFirstRow() const;
+    uint32_t getRowCount() const;
+    bool isHardware() const;
+
+private:
+    TFT_eSPI* tft;
+    Table* table;
+
+    TableRowSource source;
+    void* context;
+    uint16_t textColor;
+
+    uint32_t rowCount;
+    uint32_t firstRow;
+    bool hardware;
+
+    uint32_t lastFirstRow() const;
+    uint8_t slotOf(uint32_t row) const;
+    void fillRow(uint32_t row);
+    void fillRows(uint32_t from, uint32_t to);
+    void setScrollArea(uint16_t top, uint16_t bottom);
+    void setScrollStart(uint16_t line);
+};
+
+template <class Table>
+TableScroll<Table>::TableScroll(TFT_eSPI* tft, Table* table, TableRowSource source, void* context, uint32_t rowCount, uint16_t textColor) :
+    tft(tft), table(table), source(source), context(context), textColor(textColor),
+    rowCount(rowCount), firstRow(0), hardware(false) {
+}
+
+template <class Table>
+void TableScroll<Table>::draw() {
+#ifdef TABLE_HARDWARE_SCROLL
+    hardware = tft->getRotation() == 0 && table->getX() == 0 && table->getWidth() == tft->width();
+#endif
+
+    table->draw();
+
+    tft->startWrite();
+    if (hardware) {
+        setScrollArea(table->getRowY(0), table->getRowY(table->getRows()));
+        setScrollStart(table->getRowY(slotOf(firstRow)));
+    }
+    fillRows(firstRow, firstRow + table->getRows());
+    tft->endWrite();
+}
+
+template <class Table>
+void TableScroll<Table>::setRowCount(uint32_t count) {
+    rowCount = count;
+    refresh();
+}
+
+template <class Table>
+void TableScroll<Table>::follow(uint32_t count) {
+    auto previous = rowCount;
+    rowCount = count;
+    scrollTo(lastFirstRow());
+
+    //rows that already were in view but only now exist
+    uint32_t end = firstRow + table->getRows();
+    tft->startWrite();
+    fillRows(previous > firstRow ? previous : firstRow, count < end ? count : end);
+    tft->endWrite();
+}
+
+template <class Table>
+void TableScroll<Table>::refresh() {
+    tft->startWrite();
+    if (firstRow > lastFirstRow()) {
+        firstRow = lastFirstRow();
+        if (hardware)
+            setScrollStart(table->getRowY(slotOf(firstRow)));
+    }
+    fillRows(firstRow, firstRow + table->getRows());
+    tft->endWrite();
+}
+
+template <class Table>
+void TableScroll<Table>::scrollTo(uint32_t row) {
+    if (row > lastFirstRow())
+        row = lastFirstRow();
+    if (row == firstRow)
+        return;
+
+    uint8_t rows = table->getRows();
+    auto previous = firstRow;
+    firstRow = row;
+
+    tft->startWrite();
+    if (!hardware) {
+        fillRows(firstRow, firstRow + rows);
+    }
+    else {
+        //the slots scrolled out of view come back on the other side, only those are refilled
+        setScrollStart(table->getRowY(slotOf(firstRow)));
+        if (row > previous)
+            fillRows(row - previous < rows ? previous + rows : row, row + rows);
+        else
+            fillRows(row, previous - row < rows ? previous : row + rows);
+    }
+    tft->endWrite();
+}
+
+template <class Table>
+void TableScroll<Table>::scrollBy(int32_t rows) {
+    if (rows < 0 && (uint32_t)-rows > firstRow)
+        scrollTo(0);
+    else
+        scrollTo(firstRow + rows);
+}
+
+template <class Table>
+void TableScroll<Table>::end() {
+    if (!hardware)
+        return;
+
+    tft->startWrite();
+    setScrollArea(0, tft->height());
+    setScrollStart(0);
+    tft->endWrite();
+    hardware = false;
+}
+
+template <class Table>
+uint32_t TableScroll<Table>::getFirstRow() const {
+    return firstRow;
+}
+
+template <class Table>
+uint32_t TableScroll<Table>::getRowCount() const {
+    return rowCount;
+}
+
+template <class Table>
+bool TableScroll<Table>::isHardware() const {
+    return hardware;
+}
+
+template <class Table>
+uint32_t TableScroll<Table>::lastFirstRow() const {
+    return rowCount > table->getRows() ? rowCount - table->getRows() : 0;
+}
+
+template <class Table>
+uint8_t TableScroll<Table>::slotOf(uint32_t row) const {
+    return hardware ? row % table->getRows() : row - firstRow;
+}
+
+template <class Table>
+void TableScroll<Table>::fillRow(uint32_t row) {
+    auto slot = slotOf(row);
+    for (uint8_t column = 0; column < table->getColumns(); column++) {
+        auto text = row < rowCount ? source(row, column, context) : nullptr;
+        table->updateCellText(slot, column, text != nullptr ? text : "", textColor);
+    }
+}
+
+template <class Table>
+void TableScroll<Table>::fillRows(uint32_t from, uint32_t to) {
+    for (auto row = from; row < to; row++)
+        fillRow(row);
+}
+
+//VSCRDEF: top fixed area, scrolling area and bottom fixed area, in lines
+template <class Table>
+void TableScroll<Table>::setScrollArea(uint16_t top, uint16_t bottom) {
+    uint16_t height = tft->height();
+    tft->writecommand(0x33);
+    tft->writedata(top >> 8);
+    tft->writedata(top);
+    tft->writedata((bottom - top) >> 8);
+    tft->writedata(bottom - top);
+    tft->writedata((height - bottom) >> 8);
+    tft->writedata(height - bottom);
+}
+
+//VSCRSADD: the memory line shown at the top of the scrolling area
+template <class Table>
+void TableScroll<Table>::setScrollStart(uint16_t line) {
+    tft->writecommand(0x37);
+    tft->writedata(line >> 8);
+    tft->writedata(line);
+}
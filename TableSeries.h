@@ -0,0 +1,137 @@
+#pragma once
+
+#include <SPI.h>
+#include <TFT_eSPI.h>
+
+#include <type_traits>
+
+#include "TableScroll.h"
+#include "TableText.h"
+
+//rolling "last N readings" display: appendRow() writes the newest row into a ring of Capacity rows
+//(at least the table's row count) and TableScroll keeps the newest rows in view. With hardware
+//scrolling an append repaints exactly one row no matter how many are shown, otherwise the rows are
+//rewritten in place and only the cells whose text changed are repainted.
+template <class Table, uint16_t Capacity, uint8_t Columns>
+class TableSeries {
+public:
+    TableSeries(TFT_eSPI* tft, Table* table, uint16_t textColor);
+
+    //table must be generated first
+    void draw();
+
+    //one value per column starting at column 0, missing columns stay empty. Values can be C strings,
+    //Strings, integers or floats (printed with setDecimals() decimals)
+    template <typename... Values>
+    void appendRow(const Values&... values);
+
+    void setDecimals(uint8_t decimals);
+    //drops every row, call draw() afterwards
+    void clear();
+
+    //rows appended so far, the oldest count - Capacity of them are gone
+    uint32_t getCount() const;
+    //nullptr for rows that are gone or not appended yet
+    const char* getText(uint32_t row, uint8_t column) const;
+
+    //restores the normal (unscrolled) screen, see TableScroll::end()
+    void end();
+
+private:
+    TableScroll<Table> scroll;
+
+    char texts[Capacity][Columns][TABLE_CELL_TEXT_SIZE];
+    uint32_t count;
+    uint8_t decimals;
+
+    static const char* source(uint32_t row, uint8_t column, void* context);
+
+    void store(char* text, const char* value);
+    void store(char* text, const String& value);
+    void store(char* text, float value);
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value>::type
+    store(char* text, T value);
+};
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+TableSeries<Table, Capacity, Columns>::TableSeries(TFT_eSPI* tft, Table* table, uint16_t textColor) :
+    scroll(tft, table, source, this, 0, textColor), count(0), decimals(2) {
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+void TableSeries<Table, Capacity, Columns>::draw() {
+    scroll.draw();
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+template <typename... Values>
+void TableSeries<Table, Capacity, Columns>::appendRow(const Values&... values) {
+    static_assert(sizeof...(Values) <= Columns, "more values than columns");
+
+    auto row = texts[count % Capacity];
+    uint8_t column = 0;
+    int expand[] = {0, (store(row[column++], values), 0)...};
+    (void)expand;
+    for (; column < Columns; column++)
+        row[column][0] = '\0';
+
+    count++;
+    scroll.follow(count);
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+void TableSeries<Table, Capacity, Columns>::setDecimals(uint8_t decimals) {
+    this->decimals = decimals;
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+void TableSeries<Table, Capacity, Columns>::clear() {
+    count = 0;
+    scroll.setRowCount(0);
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+uint32_t TableSeries<Table, Capacity, Columns>::getCount() const {
+    return count;
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+const char* TableSeries<Table, Capacity, Columns>::getText(uint32_t row, uint8_t column) const {
+    if (row >= count || count - row > Capacity || column >= Columns)
+        return nullptr;
+
+    return texts[row % Capacity][column];
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+void TableSeries<Table, Capacity, Columns>::end() {
+    scroll.end();
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+const char* TableSeries<Table, Capacity, Columns>::source(uint32_t row, uint8_t column, void* context) {
+    return static_cast<TableSeries*>(context)->getText(row, column);
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+void TableSeries<Table, Capacity, Columns>::store(char* text, const char* value) {
+    tableFormatText(text, TABLE_CELL_TEXT_SIZE, value, TABLE_CELL_TEXT_SIZE);
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+void TableSeries<Table, Capacity, Columns>::store(char* text, const String& value) {
+    store(text, value.c_str());
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+void TableSeries<Table, Capacity, Columns>::store(char* text, float value) {
+    tableFormatFloat(text, TABLE_CELL_TEXT_SIZE, value, decimals);
+}
+
+template <class Table, uint16_t Capacity, uint8_t Columns>
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value>::type
+TableSeries<Table, Capacity, Columns>::store(char* text, T value) {
+    tableFormatInteger(text, TABLE_CELL_TEXT_SIZE, value);
+}
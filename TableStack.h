@@ -1,25 +1,44 @@
-//BUG: rounding errors if incorrect values are passed to setRowHeight and setColumnWidth, relative to table's size
+//NOTE: sizes passed to setRowHeight and setColumnWidth that add up to more than the table's size leave the remaining rows/columns 0 pixels
 
 #pragma once
 
 #include <SPI.h>
 #include <TFT_eSPI.h>
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-class TableStack {
+#include "TableLayout.h"
+#include "TableRender.h"
+
+//Texts = true keeps the last text of every cell for updateCellText() and updateCells() (and redraws it
+//with the cell), at sizeof(TableCellText) bytes per cell; without it those two don't compile.
+//Drawing, dirty tracking, texts and hit testing come from TableRender.
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits = 0, bool Texts = false>
+class TableStack : public TableRender<TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>> {
 public:
     TableStack(TFT_eSPI* tft, uint16_t outlineColor, uint16_t fillColor);
 
     void generate();
-    void draw() const;
+    // applies setRowHeight(), setColumnWidth() and padding changes to an already generated table:
+    // offsets are rewritten from the first changed column/row on and only cells whose geometry changed
+    // are marked dirty for flush(), step() or flushSprite(). Returns the area they covered before and
+    // after (width 0 when nothing changed), clear the part no longer covered by the table if it shrank.
+    TableRect relayout();
+    void drawScanlines();
 
-    void eraseCell(uint8_t row, uint8_t column) const;
-    void drawCellText(uint8_t row, uint8_t column, String text, uint16_t clr) const;
-    void drawCellOutline(uint8_t row, uint8_t column) const;
+    const char* getCellText(uint8_t row, uint8_t column) const;
 
     void setCellFillColor(uint8_t row, uint8_t column, uint16_t color);
     void setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color);
+    uint16_t getCellFillColor(uint8_t row, uint8_t column) const;
+    uint16_t getCellOutlineColor(uint8_t row, uint8_t column) const;
+
+    // palette mode only (PaletteBits 4 or 8), ignored otherwise; indices of 1 << PaletteBits and up are
+    // rejected: the setters do nothing and getPaletteColor() returns 0
+    void setCellFillIndex(uint8_t row, uint8_t column, uint8_t index);
+    void setCellOutlineIndex(uint8_t row, uint8_t column, uint8_t index);
+    void setPaletteColor(uint8_t index, uint16_t color);
+    uint16_t getPaletteColor(uint8_t index) const;
 
+    // 0 shares the remaining space with the other such rows/columns, takes effect on generate() or relayout()
     void setRowHeight(uint8_t row, uint16_t height);
     void setColumnWidth(uint8_t column, uint16_t width);
 
@@ -38,8 +57,6 @@ public:
     ~TableStack();
 
 private:
-    TFT_eSPI* tft;
-
     uint16_t x;
     uint16_t y;
     uint16_t width;
@@ -52,242 +69,351 @@ private:
 
     uint16_t columnWidths[MaxColumns];
     uint16_t rowHeights[MaxRows];
-    uint16_t cellCenters[MaxRows][MaxColumns][2];
-    uint16_t cellXCoordinates[MaxRows][MaxColumns];
-    uint16_t cellYCoordinates[MaxRows][MaxColumns];
+    // absolute screen coordinates, the last entry is the table's far edge
+    uint16_t columnOffsets[MaxColumns + 1];
+    uint16_t rowOffsets[MaxRows + 1];
+    // sizes passed to setColumnWidth() and setRowHeight(), 0 = automatic
+    uint16_t columnSpecs[MaxColumns];
+    uint16_t rowSpecs[MaxRows];
 
     uint16_t outlineColor, fillColor;
-    uint16_t cellFillColors[MaxRows][MaxColumns];
-    uint16_t cellOutlineColors[MaxRows][MaxColumns];
 
-    void calculateColumnWidths();
-    void calculateRowHeights();
-    void calculateCellCenters();
-    void calculateCellCoordinates();
+    // PaletteBits 0 stores RGB565 colors per cell, 4 or 8 stores per cell indices into a palette of 16 or 256 colors:
+    // direct colors: a fill and an outline plane of RGB565 values
+    // 4 bit palette: one byte per cell, fill index in the low and outline index in the high nibble
+    // 8 bit palette: a fill and an outline plane of one byte indices
+    static_assert(PaletteBits == 0 || PaletteBits == 4 || PaletteBits == 8, "PaletteBits must be 0, 4 or 8");
+    static constexpr uint32_t colorWords = PaletteBits == 4 ? (MaxRows * MaxColumns + 1) / 2
+        : PaletteBits == 8 ? MaxRows * MaxColumns : 2 * MaxRows * MaxColumns;
+
+    uint16_t cellColors[colorWords];
+    uint16_t paletteUsed;
+    uint16_t palette[PaletteBits == 0 ? 1 : 1 << PaletteBits];
+
+    // one bit per cell, row-major; set by the color setters, consumed by flush() and step()
+    uint8_t dirtyCells[(MaxRows * MaxColumns + 7) / 8];
+
+    // last text drawn by updateCellText() per cell, only with Texts
+    TableCellText cellTexts[Texts ? MaxRows * MaxColumns : 1];
+
+    void storeFillIndex(uint16_t cell, uint8_t index);
+    void storeOutlineIndex(uint16_t cell, uint8_t index);
+    uint8_t paletteIndexOf(uint16_t color);
+
+    // storage TableRender draws from
+    friend class TableRender<TableStack>;
+    static constexpr bool storesTexts = Texts;
+    TableAxis columnAxis() const { return TableAxis{columnOffsets, columnWidths}; }
+    TableAxis rowAxis() const { return TableAxis{rowOffsets, rowHeights}; }
+    TableCellText* storedTexts() { return Texts ? cellTexts : nullptr; }
+    TableCellText* acquireTexts() { return cellTexts; }
 };
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::TableStack(TFT_eSPI* tft, uint16_t outlineColor, uint16_t fillColor) :
-    tft(tft), x(X), y(Y), width(MaxWidth), height(MaxHeight),
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::TableStack(TFT_eSPI* tft, uint16_t outlineColor, uint16_t fillColor) :
+    TableRender<TableStack>(tft), x(X), y(Y), width(MaxWidth), height(MaxHeight),
     rows(MaxRows), columns(MaxColumns),
     outlineColor(outlineColor), fillColor(fillColor),
     paddingTop(0), paddingBottom(0), paddingLeft(0), paddingRight(0),
     columnWidths{0}, rowHeights{0},
-    cellCenters{{0}},
-    cellXCoordinates{{0}},
-    cellYCoordinates{{0}} {
-
-    for (auto i = 0; i < rows; i++) {
-        for (auto j = 0; j < columns; j++) {
-            cellFillColors[i][j] = fillColor;
-            cellOutlineColors[i][j] = outlineColor;
+    columnOffsets{0}, rowOffsets{0},
+    columnSpecs{0}, rowSpecs{0},
+    paletteUsed(0), palette{0},
+    dirtyCells{0}, cellTexts{} {
+
+    if (PaletteBits == 0) {
+        for (auto i = 0; i < rows * columns; i++) {
+            cellColors[i] = fillColor;
+            cellColors[rows * columns + i] = outlineColor;
         }
+        return;
     }
-}
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::generate() {
-    calculateColumnWidths();
-    calculateRowHeights();
-    calculateCellCoordinates();
-    calculateCellCenters();
+    auto fillIndex = paletteIndexOf(fillColor);
+    auto outlineIndex = paletteIndexOf(outlineColor);
+    for (auto i = 0; i < rows * columns; i++) {
+        storeFillIndex(i, fillIndex);
+        storeOutlineIndex(i, outlineIndex);
+    }
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::calculateColumnWidths() {
-    auto remainingWidth = MaxWidth - (paddingLeft + paddingRight);
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::generate() {
+    relayout();
+}
 
-    auto specifiedColumns = 0;
-    for (auto i = 0; i < columns; i++) {
-        if (columnWidths[i] != 0) {
-            specifiedColumns++;
-            remainingWidth -= columnWidths[i];
-        }
+//sizes from the specified ones, offsets from the first changed column/row on. Every cell in a changed
+//column or row is marked dirty; the damage rectangle spans both the old and the new extent, so the
+//caller can clear what the table no longer covers when it shrank.
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+TableRect TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::relayout() {
+    uint16_t left = columnOffsets[0];
+    uint16_t top = rowOffsets[0];
+    auto right = columnOffsets[columns];
+    auto bottom = rowOffsets[rows];
+
+    auto column = tableRelayout(columnSpecs, columnWidths, columnOffsets, columns, X + paddingLeft,
+        MaxWidth - paddingLeft - paddingRight);
+    auto row = tableRelayout(rowSpecs, rowHeights, rowOffsets, rows, Y + paddingTop,
+        MaxHeight - paddingTop - paddingBottom);
+
+    if (column == columns && row == rows)
+        return TableRect{columnOffsets[0], rowOffsets[0], 0, 0};
+
+    for (auto r = 0; r < rows; r++) {
+        for (auto c = r < row ? column : 0; c < columns; c++)
+            this->markDirty(r, c);
     }
 
-    float remainingColumns = columns - specifiedColumns;
-    auto equalWidth = round(remainingWidth / remainingColumns);
+    //offsets before the first changed index stay where they were, a moved origin takes the lower one
+    if (row == rows && column > 0)
+        left = columnOffsets[column];
+    else if (columnOffsets[0] < left)
+        left = columnOffsets[0];
+    if (column == columns && row > 0)
+        top = rowOffsets[row];
+    else if (rowOffsets[0] < top)
+        top = rowOffsets[0];
+    right = right > columnOffsets[columns] ? right : columnOffsets[columns];
+    bottom = bottom > rowOffsets[rows] ? bottom : rowOffsets[rows];
+    return TableRect{left, top, static_cast<uint16_t>(right - left), static_cast<uint16_t>(bottom - top)};
+}
 
-    auto currentOffset = paddingLeft;
-    for (auto i = 0; i < columns; i++) {
-        if (columnWidths[i] == 0)
-            columnWidths[i] = equalWidth;
-        currentOffset += columnWidths[i];
+//the scanlines are built on the stack, MaxWidth pixels each
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::drawScanlines() {
+    //column widths set larger than the table itself do not fit the scanlines
+    if (getWidth() > MaxWidth) {
+        this->draw();
+        return;
     }
+
+    //one scanline for the top/bottom outline of a row, one for the pixel rows in between
+    uint16_t edgeLine[MaxWidth];
+    uint16_t innerLine[MaxWidth];
+    this->pushScanlines(edgeLine, innerLine);
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::calculateRowHeights() {
-    auto remainingHeight = MaxHeight - (paddingTop + paddingBottom);
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+const char* TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getCellText(uint8_t row, uint8_t column) const {
+    if (!Texts)
+        return "";
 
-    auto specifiedRows = 0;
-    for (auto i = 0; i < rows; i++) {
-        if (rowHeights[i] != 0) {
-            specifiedRows++;
-            remainingHeight -= rowHeights[i];
-        }
-    }
+    return cellTexts[row * columns + column].text;
+}
 
-    auto remainingRows = rows - specifiedRows;
-    float equalHeight = round(remainingHeight / remainingRows);
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setCellFillColor(uint8_t row, uint8_t column, uint16_t color) {
+    if (getCellFillColor(row, column) == color)
+        return;
 
-    auto currentOffset = paddingTop;
-    for (auto i = 0; i < rows; i++) {
-        if (rowHeights[i] == 0)
-            rowHeights[i] = equalHeight;
-        currentOffset += rowHeights[i];
-    }
+    if (PaletteBits == 0)
+        cellColors[row * columns + column] = color;
+    else
+        storeFillIndex(row * columns + column, paletteIndexOf(color));
+
+    this->markDirty(row, column);
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::calculateCellCoordinates() {
-    auto currentX = X + paddingLeft;
-    auto currentY = Y + paddingTop;
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color) {
+    if (getCellOutlineColor(row, column) == color)
+        return;
 
-    for (auto row = 0; row < rows; row++) {
-        currentX = paddingLeft;
-        for (auto column = 0; column < columns; column++) {
-            cellXCoordinates[row][column] = currentX;
-            currentX += columnWidths[column];
-        }
+    if (PaletteBits == 0)
+        cellColors[rows * columns + row * columns + column] = color;
+    else
+        storeOutlineIndex(row * columns + column, paletteIndexOf(color));
 
-        for (auto i = 0; i < columns; i++) {
-            cellYCoordinates[row][i] = currentY;
-        }
+    this->markDirty(row, column);
+}
 
-        currentY += rowHeights[row];
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getCellFillColor(uint8_t row, uint8_t column) const {
+    auto cell = row * columns + column;
+    auto indices = reinterpret_cast<const uint8_t *>(cellColors);
+
+    switch (PaletteBits) {
+    case 4:
+        return palette[indices[cell] & 0x0F];
+    case 8:
+        return palette[indices[cell]];
+    default:
+        return cellColors[cell];
     }
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::calculateCellCenters() {
-    for (auto row = 0; row < rows; row++) {
-        auto trueY = Y + paddingTop;
-        for (auto i = 0; i < row; i++) {
-            trueY += rowHeights[i];
-        }
-
-        for (auto column = 0; column < columns; column++) {
-            auto x = cellXCoordinates[row][column] + columnWidths[column] / 2;
-            cellCenters[row][column][0] = x;
-            cellCenters[row][column][1] = trueY + rowHeights[row] / 2;
-        }
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getCellOutlineColor(uint8_t row, uint8_t column) const {
+    auto cell = row * columns + column;
+    auto indices = reinterpret_cast<const uint8_t *>(cellColors);
+
+    switch (PaletteBits) {
+    case 4:
+        return palette[indices[cell] >> 4];
+    case 8:
+        return palette[indices[rows * columns + cell]];
+    default:
+        return cellColors[rows * columns + cell];
     }
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::draw() const {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setCellFillIndex(uint8_t row, uint8_t column, uint8_t index) {
+    if (PaletteBits == 0 || index >= 1 << PaletteBits)
+        return;
+
+    storeFillIndex(row * columns + column, index);
+    this->markDirty(row, column);
+}
+
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setCellOutlineIndex(uint8_t row, uint8_t column, uint8_t index) {
+    if (PaletteBits == 0 || index >= 1 << PaletteBits)
+        return;
+
+    storeOutlineIndex(row * columns + column, index);
+    this->markDirty(row, column);
+}
+
+//recolors every cell using this entry, only those cells are marked dirty
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setPaletteColor(uint8_t index, uint16_t color) {
+    if (PaletteBits == 0 || index >= 1 << PaletteBits)
+        return;
+
+    if (paletteUsed <= index)
+        paletteUsed = index + 1;
+
+    if (palette[index] == color)
+        return;
+
+    palette[index] = color;
+
+    auto indices = reinterpret_cast<const uint8_t *>(cellColors);
     for (auto row = 0; row < rows; row++) {
         for (auto column = 0; column < columns; column++) {
-            auto x = cellXCoordinates[row][column];
-            auto y = cellYCoordinates[row][column];
-            auto width = columnWidths[column];
-            auto height = rowHeights[row];
-            auto fillColor = cellFillColors[row][column];
-            auto outlineColor = cellOutlineColors[row][column];
-
-            tft->fillRect(x, y, width, height, fillColor);
-            tft->drawRect(x, y, width, height, outlineColor);
+            auto cell = row * columns + column;
+            auto used = PaletteBits == 4
+                ? (indices[cell] & 0x0F) == index || indices[cell] >> 4 == index
+                : indices[cell] == index || indices[rows * columns + cell] == index;
+
+            if (used)
+                this->markDirty(row, column);
         }
     }
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::drawCellText(uint8_t row, uint8_t column, String text, uint16_t clr) const {
-    tft->setTextColor(clr);
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getPaletteColor(uint8_t index) const {
+    if (PaletteBits == 0 || index >= 1 << PaletteBits)
+        return 0;
 
-    auto x = cellCenters[row][column][0];
-    auto y = cellCenters[row][column][1];
+    return palette[index];
+}
 
-    tft->drawString(text, x, y);
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::storeFillIndex(uint16_t cell, uint8_t index) {
+    auto indices = reinterpret_cast<uint8_t *>(cellColors);
 
-    tft->setTextColor(ILI9486_WHITE);
+    if (PaletteBits == 4)
+        indices[cell] = (indices[cell] & 0xF0) | (index & 0x0F);
+    else
+        indices[cell] = index;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::drawCellOutline(uint8_t row, uint8_t column) const {
-    auto x = cellXCoordinates[row][column];
-    auto y = cellYCoordinates[row][column];
-    auto width = columnWidths[column];
-    auto height = rowHeights[row];
-    auto outlineColor = cellOutlineColors[row][column];
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::storeOutlineIndex(uint16_t cell, uint8_t index) {
+    auto indices = reinterpret_cast<uint8_t *>(cellColors);
 
-    tft->drawRect(x, y, width, height, outlineColor);
+    if (PaletteBits == 4)
+        indices[cell] = (indices[cell] & 0x0F) | (index << 4);
+    else
+        indices[rows * columns + cell] = index;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::eraseCell(uint8_t row, uint8_t column) const {
-    auto x = cellXCoordinates[row][column];
-    auto y = cellYCoordinates[row][column];
-    auto width = columnWidths[column];
-    auto height = rowHeights[row];
-    auto fillColor = cellFillColors[row][column];
+//an existing entry holding the color, else the next unused entry, else the closest color in the palette
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint8_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::paletteIndexOf(uint16_t color) {
+    for (uint16_t i = 0; i < paletteUsed; i++) {
+        if (palette[i] == color)
+            return i;
+    }
 
-    tft->fillRect(x + 1, y + 1, width - 2, height - 2, fillColor);
-}
+    if (paletteUsed < (1 << PaletteBits)) {
+        palette[paletteUsed] = color;
+        return paletteUsed++;
+    }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::setCellFillColor(uint8_t row, uint8_t column, uint16_t color) {
-    cellFillColors[row][column] = color;
-}
+    uint8_t closest = 0;
+    uint32_t closestDistance = UINT32_MAX;
+    for (uint16_t i = 0; i < paletteUsed; i++) {
+        int32_t red = (palette[i] >> 11) - (color >> 11);
+        int32_t green = ((palette[i] >> 5) & 0x3F) - ((color >> 5) & 0x3F);
+        int32_t blue = (palette[i] & 0x1F) - (color & 0x1F);
+        uint32_t distance = 4 * red * red + green * green + 4 * blue * blue;
+
+        if (distance < closestDistance) {
+            closest = i;
+            closestDistance = distance;
+        }
+    }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::setCellOutlineColor(uint8_t row, uint8_t column, uint16_t color) {
-    cellOutlineColors[row][column] = color;
+    return closest;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::setRowHeight(uint8_t row, uint16_t height) {
-    rowHeights[row] = height;
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setRowHeight(uint8_t row, uint16_t height) {
+    rowSpecs[row] = height;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::setColumnWidth(uint8_t column, uint16_t width) {
-    columnWidths[column] = width;
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setColumnWidth(uint8_t column, uint16_t width) {
+    columnSpecs[column] = width;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::setPaddingTop(uint16_t top) {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setPaddingTop(uint16_t top) {
     paddingTop = top;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::setPaddingBottom(uint16_t bottom) {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setPaddingBottom(uint16_t bottom) {
     paddingBottom = bottom;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::setPaddingLeft(uint16_t left) {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setPaddingLeft(uint16_t left) {
     paddingLeft = left;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::setPaddingRight(uint16_t right) {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+void TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::setPaddingRight(uint16_t right) {
     paddingRight = right;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::getX() const {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getX() const {
     return X + paddingLeft;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::getY() const {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getY() const {
     return Y + paddingTop;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-uint8_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::getRows() const {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint8_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getRows() const {
     return rows;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-uint8_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::getColumns() const {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint8_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getColumns() const {
     return columns;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::getWidth() const {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getWidth() const {
     uint16_t width = 0;
     for (uint8_t column = 0; column < columns; column++) {
         width += columnWidths[column];
@@ -295,8 +421,8 @@ uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::getWidth()
     return width;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::getHeight() const {
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::getHeight() const {
     uint16_t height = 0;
     for (uint8_t row = 0; row < rows; row++) {
         height += rowHeights[row];
@@ -304,5 +430,5 @@ uint16_t TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::getHeight()
     return height;
 }
 
-template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns>
-TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns>::~TableStack() {}
\ No newline at end of file
+template <uint16_t X, uint16_t Y, uint16_t MaxWidth, uint16_t MaxHeight, uint8_t MaxRows, uint8_t MaxColumns, uint8_t PaletteBits, bool Texts>
+TableStack<X, Y, MaxWidth, MaxHeight, MaxRows, MaxColumns, PaletteBits, Texts>::~TableStack() {}
\ No newline at end of file
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+#include <string.h>
+
+//render instrumentation, enabled by building with TABLE_STATS defined (a build flag, TableHeap.cpp is
+//compiled on its own). Tables then count per operation the calls, pixels written, address windows
+//(bus transactions) and microseconds spent; without it the macros below expand to nothing and the
+//tables carry no extra state.
+
+enum TableStatsOperation : uint8_t {
+  TABLE_STATS_DRAW,         //draw(), drawScanlines()
+  TABLE_STATS_FLUSH,        //flush(), step()
+  TABLE_STATS_ERASE_CELL,   //eraseCell()
+  TABLE_STATS_CELL_TEXT,    //drawCellText(), updateCellText(), updateCells()
+  TABLE_STATS_CELL_OUTLINE, //drawCellOutline()
+  TABLE_STATS_OPERATIONS
+};
+
+struct TableOperationStats {
+  uint32_t calls;
+  uint32_t pixels;
+  uint32_t transactions;
+  uint32_t micros;
+};
+
+struct TableStats {
+  TableOperationStats operations[TABLE_STATS_OPERATIONS];
+  //operation the pixels being drawn are charged to, TABLE_STATS_OPERATIONS outside of all of them
+  uint8_t current;
+
+  void reset() {
+    memset(operations, 0, sizeof(operations));
+    current = TABLE_STATS_OPERATIONS;
+  }
+
+  void count(uint32_t pixels, uint32_t transactions) {
+    if (current == TABLE_STATS_OPERATIONS)
+      return;
+
+    operations[current].pixels += pixels;
+    operations[current].transactions += transactions;
+  }
+
+  void rect(int32_t width, int32_t height) {
+    if (width > 0 && height > 0)
+      count(width * height, 1);
+  }
+
+  //drawRect() is four lines
+  void outline(int32_t width, int32_t height) {
+    if (width > 0 && height > 0)
+      count(width > 1 && height > 1 ? 2 * (width + height) - 4 : width * height, 4);
+  }
+
+  void line(int32_t length) {
+    if (length > 0)
+      count(length, 1);
+  }
+
+  //estimated as the text's box, the fonts open one window per character
+  void text(size_t length, int32_t width, int32_t height) {
+    if (width > 0 && height > 0)
+      count(width * height, length);
+  }
+};
+
+//charges one call and the time until the end of the scope to an operation; public calls nested in
+//another one (the float drawCellText() forwarding to the text one, texts redrawn by draw()) stay
+//charged to the outermost
+class TableStatsScope {
+public:
+  TableStatsScope(TableStats &stats, uint8_t operation) : stats(stats), outermost(stats.current == TABLE_STATS_OPERATIONS), start(0) {
+    if (!outermost)
+      return;
+
+    stats.current = operation;
+    start = micros();
+  }
+
+  ~TableStatsScope() {
+    if (!outermost)
+      return;
+
+    auto &operation = stats.operations[stats.current];
+    operation.calls++;
+    operation.micros += micros() - start;
+    stats.current = TABLE_STATS_OPERATIONS;
+  }
+
+private:
+  TableStats &stats;
+  bool outermost;
+  uint32_t start;
+};
+
+#ifdef TABLE_STATS
+#define TABLE_STATS_SCOPE(operation) TableStatsScope tableStatsScope(stats, operation)
+#define TABLE_STATS_RECT(width, height) stats.rect(width, height)
+#define TABLE_STATS_OUTLINE(width, height) stats.outline(width, height)
+#define TABLE_STATS_LINE(length) stats.line(length)
+#define TABLE_STATS_WINDOW() stats.count(0, 1)
+#define TABLE_STATS_PIXELS(pixels) stats.count(pixels, 0)
+#define TABLE_STATS_TEXT(string, width) stats.text(strlen(string), width, tft->fontHeight())
+#else
+#define TABLE_STATS_SCOPE(operation)
+#define TABLE_STATS_RECT(width, height)
+#define TABLE_STATS_OUTLINE(width, height)
+#define TABLE_STATS_LINE(length)
+#define TABLE_STATS_WINDOW()
+#define TABLE_STATS_PIXELS(pixels)
+#define TABLE_STATS_TEXT(string, width)
+#endif
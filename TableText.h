@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+//longest text (including the terminator) a cell remembers for updateCellText(), longer texts are cut
+#ifndef TABLE_CELL_TEXT_SIZE
+#define TABLE_CELL_TEXT_SIZE 12
+#endif
+
+//what is currently drawn in a cell
+struct TableCellText {
+  char text[TABLE_CELL_TEXT_SIZE];
+  uint16_t width;
+  uint16_t color;
+};
+
+//one entry of updateCells(); the text only has to stay valid for the duration of the call
+struct TableCellUpdate {
+  uint8_t row;
+  uint8_t column;
+  const char *text;
+  uint16_t color;
+};
+
+//remembers text/color in cell, false if that is exactly what the cell already shows
+inline bool tableStoreText(TableCellText &cell, const char *text, uint16_t color) {
+  if (cell.color == color && strncmp(cell.text, text, TABLE_CELL_TEXT_SIZE - 1) == 0)
+    return false;
+
+  strncpy(cell.text, text, TABLE_CELL_TEXT_SIZE - 1);
+  cell.text[TABLE_CELL_TEXT_SIZE - 1] = '\0';
+  cell.color = color;
+  return true;
+}
+
+//stable insertion sort into raster order: batches are small, often nearly sorted already, and nothing
+//is allocated. Later updates of the same cell stay behind earlier ones
+inline void tableSortUpdates(TableCellUpdate *updates, uint16_t count) {
+  for (uint16_t i = 1; i < count; i++) {
+    auto update = updates[i];
+    auto key = (update.row << 8) | update.column;
+    auto j = i;
+    while (j > 0 && ((updates[j - 1].row << 8) | updates[j - 1].column) > key) {
+      updates[j] = updates[j - 1];
+      j--;
+    }
+    updates[j] = update;
+  }
+}
+
+//per-table scratch space the numeric and (text, length) overloads format into, no heap is involved
+#ifndef TABLE_TEXT_BUFFER_SIZE
+#define TABLE_TEXT_BUFFER_SIZE 24
+#endif
+
+//the formatters below write into buffer (size bytes including the terminator), cut the result to fit
+//and return its length
+
+inline uint8_t tableFormatText(char *buffer, uint8_t size, const char *text, size_t length) {
+  uint8_t written = 0;
+  while (written < length && written < size - 1 && text[written] != '\0') {
+    buffer[written] = text[written];
+    written++;
+  }
+  buffer[written] = '\0';
+  return written;
+}
+
+inline uint8_t tableFormatUnsigned(char *buffer, uint8_t size, unsigned long value, bool negative = false) {
+  char digits[20];
+  uint8_t count = 0;
+  do {
+    digits[count++] = '0' + value % 10;
+    value /= 10;
+  } while (value != 0);
+
+  uint8_t written = 0;
+  if (negative && written < size - 1)
+    buffer[written++] = '-';
+  while (count > 0 && written < size - 1)
+    buffer[written++] = digits[--count];
+  buffer[written] = '\0';
+  return written;
+}
+
+//any integer type up to unsigned long (wider values are cut to unsigned long)
+template <typename T>
+inline uint8_t tableFormatInteger(char *buffer, uint8_t size, T value) {
+  //negate as unsigned so the type's minimum doesn't overflow
+  return value < T() ? tableFormatUnsigned(buffer, size, 0UL - (unsigned long)value, true)
+                     : tableFormatUnsigned(buffer, size, (unsigned long)value);
+}
+
+//fixed point with up to 7 decimals, rounded half away from zero; values beyond the unsigned long range
+//print as "ovf" like Arduino's Print does
+inline uint8_t tableFormatFloat(char *buffer, uint8_t size, float value, uint8_t decimals) {
+  if (value != value)
+    return tableFormatText(buffer, size, "nan", 3);
+
+  bool negative = value < 0;
+  if (negative)
+    value = -value;
+
+  if (value > 4294967040.0f)
+    return tableFormatText(buffer, size, "ovf", 3);
+
+  if (decimals > 7)
+    decimals = 7;
+
+  unsigned long scale = 1;
+  for (uint8_t i = 0; i < decimals; i++)
+    scale *= 10;
+
+  unsigned long whole = (unsigned long)value;
+  unsigned long fraction = (unsigned long)((value - whole) * scale + 0.5f);
+  if (fraction >= scale) {
+    whole++;
+    fraction -= scale;
+  }
+
+  auto written = tableFormatUnsigned(buffer, size, whole, negative && (whole != 0 || fraction != 0));
+  if (decimals == 0 || written >= size - 2)
+    return written;
+
+  buffer[written++] = '.';
+  for (uint8_t i = decimals; i > 0 && written < size - 1; i--) {
+    scale /= 10;
+    buffer[written++] = '0' + (fraction / scale) % 10;
+  }
+  buffer[written] = '\0';
+  return written;
+}
@@ -0,0 +1,125 @@
+//cost of every table operation per grid size, against the recording TFT_eSPI stand-in: pixels, calls
+//and address windows are what the panel would receive, wall time is the CPU side only (no bus)
+
+#include <chrono>
+#include <functional>
+#include <memory>
+
+#include "TableHeap.h"
+#include "TableStack.h"
+
+static TFT_eSPI tft;
+
+//runs op until at least 20 ms have passed (at least 3 times), counters are taken from the first run
+static void measure(const char *table, uint8_t rows, uint8_t columns, const char *operation,
+    std::function<void()> setup, std::function<void()> op) {
+  setup();
+  tft.reset();
+  op();
+  auto counters = tft.counters;
+
+  uint32_t runs = 1;
+  std::chrono::nanoseconds spent(0);
+  while (runs < 3 || (spent < std::chrono::milliseconds(20) && runs < 10000)) {
+    setup();
+    auto start = std::chrono::steady_clock::now();
+    op();
+    spent += std::chrono::steady_clock::now() - start;
+    runs++;
+  }
+
+  char grid[8];
+  snprintf(grid, sizeof(grid), "%ux%u", rows, columns);
+  printf("%-6s %-8s %-14s %10u %8u %8u %10.1f\n", table, grid, operation, counters.pixels, counters.calls,
+    counters.windows, spent.count() / 1000.0 / (runs - 1));
+}
+
+template <class Table>
+static void recolor(Table &table, uint16_t color) {
+  for (uint8_t row = 0; row < table.getRows(); row++) {
+    for (uint16_t column = row % 8; column < table.getColumns(); column += 8)
+      table.setCellFillColor(row, column, color);
+  }
+}
+
+template <class Table>
+static void run(const char *name, Table &table) {
+  auto rows = table.getRows();
+  auto columns = table.getColumns();
+  auto none = [] {};
+  uint16_t color = 0;
+
+  table.generate();
+  measure(name, rows, columns, "draw", none, [&] { table.draw(); });
+  measure(name, rows, columns, "drawScanlines", none, [&] { table.drawScanlines(); });
+
+  //an eighth of the cells recolored before each run
+  measure(name, rows, columns, "flush", [&] { recolor(table, ++color); }, [&] { table.flush(); });
+  measure(name, rows, columns, "flushSprite", [&] { recolor(table, ++color); }, [&] {
+    TFT_eSprite sprite(&tft);
+    table.flushSprite(&sprite, 8192);
+  });
+  measure(name, rows, columns, "step", [&] { table.beginDraw(); }, [&] {
+    while (table.step(0)) {
+    }
+  });
+
+  //every cell once per run
+  measure(name, rows, columns, "eraseCell", none, [&] {
+    for (uint8_t row = 0; row < rows; row++) {
+      for (uint8_t column = 0; column < columns; column++)
+        table.eraseCell(row, column);
+    }
+  });
+  measure(name, rows, columns, "drawCellText", none, [&] {
+    for (uint8_t row = 0; row < rows; row++) {
+      for (uint8_t column = 0; column < columns; column++)
+        table.drawCellText(row, column, 123.4f, 1, TFT_WHITE);
+    }
+  });
+
+  int32_t value = 0;
+  measure(name, rows, columns, "updateCellText", [&] { value++; }, [&] {
+    for (uint8_t row = 0; row < rows; row++) {
+      for (uint8_t column = 0; column < columns; column++)
+        table.updateCellText(row, column, value, TFT_WHITE);
+    }
+  });
+
+  std::unique_ptr<TableCellUpdate[]> updates(new TableCellUpdate[rows * columns]);
+  char text[TABLE_CELL_TEXT_SIZE];
+  measure(name, rows, columns, "updateCells", [&] {
+    tableFormatInteger(text, sizeof(text), ++value);
+    for (uint16_t i = 0; i < rows * columns; i++)
+      updates[i] = {(uint8_t)(i / columns), (uint8_t)(i % columns), text, TFT_WHITE};
+  }, [&] { table.updateCells(updates.get(), rows * columns); });
+}
+
+static void heap(uint8_t rows, uint8_t columns) {
+  TableHeap table(&tft, 0, 0, 480, 320, rows, columns, TFT_WHITE, TFT_BLACK);
+  run("heap", table);
+}
+
+template <uint8_t Rows, uint8_t Columns>
+static void stack() {
+  std::unique_ptr<TableStack<0, 0, 480, 320, Rows, Columns, 0, true>> table(
+    new TableStack<0, 0, 480, 320, Rows, Columns, 0, true>(&tft, TFT_WHITE, TFT_BLACK));
+  run("stack", *table);
+}
+
+int main() {
+  printf("%-6s %-8s %-14s %10s %8s %8s %10s\n", "table", "grid", "operation", "pixels", "calls", "windows", "us/op");
+
+  const uint8_t sizes[][2] = {{2, 3}, {4, 4}, {8, 8}, {16, 16}, {32, 32}, {64, 64}, {128, 128}, {255, 255}};
+  for (auto &size : sizes)
+    heap(size[0], size[1]);
+
+  stack<2, 3>();
+  stack<4, 4>();
+  stack<8, 8>();
+  stack<16, 16>();
+  stack<32, 32>();
+  stack<64, 64>();
+  stack<128, 128>();
+  stack<255, 255>();
+}
@@ -0,0 +1,115 @@
+//TableRenderQueue under load: a std::thread producer against a consumer thread, for throughput and
+//push latency, then TableRenderTask applying the commands to a table (CPU side only, no bus)
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "TableHeap.h"
+#include "TableRenderTask.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const uint32_t count = 2000000;
+
+static double nanoseconds(Clock::duration duration) {
+  return std::chrono::duration_cast<std::chrono::duration<double, std::nano>>(duration).count();
+}
+
+//every push timed on its own, a full queue counted as one retry per failed attempt
+template <uint16_t Capacity>
+static void queue() {
+  static TableRenderQueue<Capacity> queue;
+  std::vector<float> latencies(count);
+  uint32_t retries = 0;
+
+  auto start = Clock::now();
+  std::thread producer([&] {
+    TableCellCommand command = {TABLE_COMMAND_FILL, 0, 0, 0, ""};
+    for (uint32_t i = 0; i < count; i++) {
+      command.row = i % 255;
+      command.column = i % 253;
+      command.color = i;
+
+      auto before = Clock::now();
+      while (!queue.push(command)) {
+        retries++;
+        std::this_thread::yield();
+      }
+      latencies[i] = nanoseconds(Clock::now() - before);
+    }
+  });
+
+  TableCellCommand command;
+  for (uint32_t received = 0; received < count;) {
+    if (queue.pop(command))
+      received++;
+    else
+      std::this_thread::yield();
+  }
+  producer.join();
+  auto seconds = nanoseconds(Clock::now() - start) / 1e9;
+
+  std::sort(latencies.begin(), latencies.end());
+  printf("queue  %-8u %10.2f %8.0f %8.0f %10.0f %10u\n", Capacity, count / seconds / 1e6, latencies[count / 2],
+    latencies[count * 99 / 100], latencies[count - 1], retries);
+}
+
+//the producer rewrites the cells of a small hot region, as a live display does, the consumer renders
+//in batches; "kept" is the share of commands left after coalescing
+template <uint16_t Capacity, uint16_t BatchSize>
+static void task() {
+  TFT_eSPI tft;
+  TableHeap table(&tft, 0, 0, 480, 320, 16, 16, TFT_WHITE, TFT_BLACK);
+  table.generate();
+  table.draw();
+
+  static TableRenderTask<TableHeap, Capacity, BatchSize> task(&table);
+  const uint32_t commands = 20000;
+  std::atomic<bool> done(false);
+
+  auto start = Clock::now();
+  std::thread producer([&] {
+    char text[TABLE_CELL_TEXT_SIZE];
+    for (uint32_t i = 0; i < commands; i++) {
+      uint8_t row = i % 4;
+      uint8_t column = i / 4 % 4;
+      snprintf(text, sizeof(text), "%u", i);
+      auto push = [&] {
+        return i % 2 == 0 ? task.updateCellText(row, column, text, TFT_WHITE) : task.setCellFillColor(row, column, i);
+      };
+      while (!push())
+        std::this_thread::yield();
+    }
+    done = true;
+  });
+
+  uint32_t kept = 0;
+  uint32_t batches = 0;
+  while (!done) {
+    auto applied = task.render();
+    kept += applied;
+    batches += applied > 0;
+  }
+  producer.join();
+  for (uint16_t applied; (applied = task.render()) > 0; batches++)
+    kept += applied;
+  auto seconds = nanoseconds(Clock::now() - start) / 1e9;
+
+  printf("task   %-4u %-4u %10.2f %8u %7.1f%%\n", Capacity, BatchSize, commands / seconds / 1e6, batches,
+    100.0 * kept / commands);
+}
+
+int main() {
+  printf("%-6s %-8s %10s %8s %8s %10s %10s\n", "", "capacity", "Mpush/s", "p50 ns", "p99 ns", "max ns", "retries");
+  queue<16>();
+  queue<64>();
+  queue<256>();
+  queue<1024>();
+
+  printf("\n%-6s %-4s %-4s %10s %8s %8s\n", "", "cap", "batch", "Mcmd/s", "batches", "kept");
+  task<64, 32>();
+  task<256, 32>();
+  task<256, 128>();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+//desktop stand-in for the parts of the Arduino core the tables use: micros()/millis() from the
+//steady clock and a String that only wraps std::string
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <chrono>
+#include <string>
+
+inline uint32_t micros() {
+  static auto start = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+inline uint32_t millis() {
+  return micros() / 1000;
+}
+
+class String {
+public:
+  String(const char *text = "") : text(text) {}
+  String(int value) : text(std::to_string(value)) {}
+  String(long value) : text(std::to_string(value)) {}
+  String(unsigned value) : text(std::to_string(value)) {}
+  String(unsigned long value) : text(std::to_string(value)) {}
+  String(double value, unsigned char decimals = 2) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+    text = buffer;
+  }
+
+  const char *c_str() const { return text.c_str(); }
+  unsigned length() const { return text.length(); }
+
+  bool operator==(const String &other) const { return text == other.text; }
+  String operator+(const String &other) const { return String((text + other.text).c_str()); }
+
+private:
+  std::string text;
+};
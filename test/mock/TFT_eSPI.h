@@ -0,0 +1,257 @@
+#pragma once
+
+//recording stand-in for TFT_eSPI on a desktop: an RGB565 framebuffer plus counters of what a panel
+//would see, so draw paths can be compared pixel by pixel and measured without a board. Only what the
+//tables use is provided. Costs follow the real library: every fillRect()/line/pushColors() window is
+//one address window, drawRect() is four lines, drawString() with a background opens one window per
+//character of the built-in 6x8 font and a transparent one writes its set pixels one by one.
+
+#include "Arduino.h"
+
+#include <vector>
+
+#define TFT_BLACK 0x0000
+#define TFT_BLUE 0x001F
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_YELLOW 0xFFE0
+#define TFT_WHITE 0xFFFF
+#define ILI9486_WHITE TFT_WHITE
+
+#define TL_DATUM 0
+#define MC_DATUM 4
+
+//as in the default User_Setup.h
+#define LOAD_GFXFF
+#define SMOOTH_FONT
+
+//free fonts are only told apart from the built-in ones, nothing is drawn with them
+struct GFXfont {
+  const uint8_t *bitmap;
+};
+
+struct MockCounters {
+  uint32_t calls;        //drawing calls, each line of drawRect() counted
+  uint32_t windows;      //address windows opened
+  uint32_t pixels;       //pixels written, clipped ones included
+  uint32_t transactions; //startWrite() calls
+  uint32_t strings;      //drawString() calls
+  uint32_t commands;     //writecommand() calls
+};
+
+class TFT_eSPI {
+public:
+  TFT_eSPI(int16_t width = 480, int16_t height = 320) : textfont(1), textsize(1), textdatum(MC_DATUM),
+    DMA_Enabled(false), fontLoaded(false), gfxFont(nullptr), screenWidth(width), screenHeight(height), rotation(0), textColor(TFT_WHITE),
+    textBackground(TFT_WHITE), padding(0), windowX(0), windowY(0), windowWidth(0), windowPosition(0) {
+    fill(0);
+    reset();
+  }
+  virtual ~TFT_eSPI() {}
+
+  uint8_t textfont;
+  uint8_t textsize;
+  uint8_t textdatum;
+  bool DMA_Enabled;
+  bool fontLoaded;
+  GFXfont *gfxFont;
+
+  MockCounters counters;
+  std::vector<uint16_t> frame;
+
+  //test side
+  void reset() { memset(&counters, 0, sizeof(counters)); }
+  void fill(uint16_t color) { frame.assign(screenWidth * screenHeight, color); }
+  uint16_t pixel(int32_t x, int32_t y) const { return frame[y * screenWidth + x]; }
+
+  void startWrite() { counters.transactions++; }
+  void endWrite() {}
+
+  void fillRect(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t color) {
+    counters.calls++;
+    if (width <= 0 || height <= 0)
+      return;
+
+    counters.windows++;
+    for (int32_t j = 0; j < height; j++) {
+      for (int32_t i = 0; i < width; i++)
+        write(x + i, y + j, color);
+    }
+  }
+
+  //as TFT_eSPI draws it: top and bottom lines across, left and right lines in between
+  void drawRect(int32_t x, int32_t y, int32_t width, int32_t height, uint32_t color) {
+    drawFastHLine(x, y, width, color);
+    drawFastHLine(x, y + height - 1, width, color);
+    drawFastVLine(x, y + 1, height - 2, color);
+    drawFastVLine(x + width - 1, y + 1, height - 2, color);
+  }
+
+  void drawFastHLine(int32_t x, int32_t y, int32_t width, uint32_t color) { fillRect(x, y, width, 1, color); }
+  void drawFastVLine(int32_t x, int32_t y, int32_t height, uint32_t color) { fillRect(x, y, 1, height, color); }
+
+  void setAddrWindow(int32_t x, int32_t y, int32_t width, int32_t height) {
+    (void)height;
+    counters.windows++;
+    windowX = x;
+    windowY = y;
+    windowWidth = width;
+    windowPosition = 0;
+  }
+
+  void pushColors(uint16_t *data, uint32_t length, bool swap = true) {
+    (void)swap;
+    counters.calls++;
+    for (uint32_t i = 0; i < length; i++, windowPosition++)
+      write(windowX + windowPosition % windowWidth, windowY + windowPosition / windowWidth, data[i]);
+  }
+
+  void dmaWait() {}
+  bool getSwapBytes() { return true; }
+  void setSwapBytes(bool swap) { (void)swap; }
+
+  void setTextColor(uint16_t color) { textColor = textBackground = color; }
+  void setTextColor(uint16_t color, uint16_t background, bool fill = false) {
+    (void)fill;
+    textColor = color;
+    textBackground = background;
+  }
+  void setTextPadding(uint16_t width) { padding = width; }
+  void setTextFont(uint8_t font) {
+    textfont = font;
+    gfxFont = nullptr;
+  }
+  void setFreeFont(const GFXfont *font = nullptr) {
+    textfont = 1;
+    gfxFont = const_cast<GFXfont *>(font);
+  }
+  void setTextSize(uint8_t size) { textsize = size > 0 ? size : 1; }
+  void setTextDatum(uint8_t datum) { textdatum = datum; }
+
+  int16_t textWidth(const char *text) { return 6 * textsize * strlen(text); }
+  int16_t textWidth(const String &text) { return textWidth(text.c_str()); }
+  int16_t fontHeight() { return 8 * textsize; }
+
+  //every character is a 6x8 block (scaled by the text size) whose set pixels depend on the character,
+  //so different texts leave different pixels
+  int16_t drawString(const char *text, int32_t x, int32_t y) {
+    counters.calls++;
+    counters.strings++;
+
+    int32_t width = textWidth(text);
+    int32_t height = fontHeight();
+    if (textdatum == MC_DATUM) {
+      x -= width / 2;
+      y -= height / 2;
+    }
+
+    bool opaque = textColor != textBackground;
+    for (size_t k = 0; text[k] != '\0'; k++) {
+      if (opaque)
+        counters.windows++;
+      for (int32_t j = 0; j < height; j++) {
+        for (int32_t i = 0; i < 6 * textsize; i++) {
+          if (isSet(text[k], i / textsize, j / textsize)) {
+            if (!opaque)
+              counters.windows++;
+            write(x + 6 * textsize * k + i, y + j, textColor);
+          }
+          else if (opaque)
+            write(x + 6 * textsize * k + i, y + j, textBackground);
+        }
+      }
+    }
+
+    //padding around the text, split evenly for centered text
+    if (opaque && padding > width) {
+      int32_t left = textdatum == MC_DATUM ? (padding - width) / 2 : 0;
+      fillRect(x - left, y, left, height, textBackground);
+      fillRect(x + width, y, padding - width - left, height, textBackground);
+    }
+
+    return width;
+  }
+  int16_t drawString(const String &text, int32_t x, int32_t y) { return drawString(text.c_str(), x, y); }
+
+  void setRotation(uint8_t rotation) { this->rotation = rotation; }
+  uint8_t getRotation() { return rotation; }
+  int16_t width() { return screenWidth; }
+  int16_t height() { return screenHeight; }
+
+  void writecommand(uint8_t command) {
+    (void)command;
+    counters.commands++;
+  }
+  void writedata(uint8_t data) { (void)data; }
+
+protected:
+  int32_t screenWidth;
+  int32_t screenHeight;
+
+  void write(int32_t x, int32_t y, uint16_t color) {
+    counters.pixels++;
+    if (x >= 0 && y >= 0 && x < screenWidth && y < screenHeight)
+      frame[y * screenWidth + x] = color;
+  }
+
+private:
+  uint8_t rotation;
+  uint16_t textColor;
+  uint16_t textBackground;
+  uint16_t padding;
+
+  int32_t windowX;
+  int32_t windowY;
+  int32_t windowWidth;
+  uint32_t windowPosition;
+
+  static bool isSet(char character, int32_t column, int32_t row) {
+    return column < 5 && row < 7 && (column + row + character) % 3 == 0;
+  }
+};
+
+//16 bit sprites only; drawing counts on the sprite, pushSprite() on the screen it was created for
+class TFT_eSprite : public TFT_eSPI {
+public:
+  TFT_eSprite(TFT_eSPI *screen) : TFT_eSPI(0, 0), screen(screen) {}
+
+  //sprites larger than this fail to allocate, for testing the fallbacks
+  static uint32_t &maxBytes() {
+    static uint32_t bytes = 0xFFFFFFFF;
+    return bytes;
+  }
+
+  void setColorDepth(int8_t depth) { (void)depth; }
+
+  void *createSprite(int16_t width, int16_t height, uint8_t frames = 1) {
+    (void)frames;
+    if (width <= 0 || height <= 0 || 2u * width * height > maxBytes())
+      return nullptr;
+
+    screenWidth = width;
+    screenHeight = height;
+    frame.assign(width * height, 0);
+    return frame.data();
+  }
+
+  void deleteSprite() {
+    screenWidth = screenHeight = 0;
+    frame.clear();
+  }
+
+  void fillSprite(uint32_t color) {
+    counters.calls++;
+    for (auto &pixel : frame)
+      pixel = color;
+  }
+
+  uint16_t readPixel(int32_t x, int32_t y) { return pixel(x, y); }
+
+  void pushSprite(int32_t x, int32_t y) {
+    screen->setAddrWindow(x, y, screenWidth, screenHeight);
+    screen->pushColors(frame.data(), frame.size());
+  }
+
+private:
+  TFT_eSPI *screen;
+};
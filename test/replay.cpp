@@ -0,0 +1,144 @@
+//replays recorded binary frames (see TableFrames.h) into a table on the desktop, fed in chunks the
+//way a UART receive buffer fills, and reports what the decoder made of them
+//
+//  replay record FILE [FRAMES] [NOISE]  writes FRAMES frames (10000) for a 16x16 table, with one in
+//                                       NOISE frames (0, none) corrupted, dropped, repeated or cut
+//  replay play FILE|- [CHUNK]           decodes FILE (- for stdin) CHUNK bytes at a time (64)
+
+#include <chrono>
+#include <vector>
+
+#include "TableFrames.h"
+#include "TableHeap.h"
+
+static const uint8_t rows = 16;
+static const uint8_t columns = 16;
+
+//deterministic, so recordings can be compared between runs
+static uint32_t next(uint32_t &state) {
+  state = state * 1664525 + 1013904223;
+  return state >> 8;
+}
+
+static int record(const char *path, uint32_t count, uint32_t noise) {
+  FILE *file = fopen(path, "wb");
+  if (file == nullptr) {
+    perror(path);
+    return 1;
+  }
+
+  uint32_t state = 1;
+  uint8_t buffer[TABLE_FRAME_HEADER_SIZE + TABLE_FRAME_MAX_PAYLOAD + 1];
+  TableFrameWriter writer(buffer, sizeof(buffer));
+  char text[TABLE_CELL_TEXT_SIZE];
+
+  for (uint32_t sequence = 0; sequence < count; sequence++) {
+    writer.begin(sequence);
+    auto records = 1 + next(state) % 24;
+    for (uint32_t i = 0; i < records; i++) {
+      uint16_t cell = next(state) % (rows * columns);
+      uint16_t color = next(state);
+      switch (next(state) % 5) {
+      case TABLE_FRAME_FILL:
+        writer.fill(cell, color);
+        break;
+      case TABLE_FRAME_OUTLINE:
+        writer.outline(cell, color);
+        break;
+      case TABLE_FRAME_TEXT:
+        snprintf(text, sizeof(text), "t%u", next(state) % 1000);
+        writer.text(cell, color, text);
+        break;
+      case TABLE_FRAME_INTEGER:
+        writer.integer(cell, color, (int32_t)next(state) - 0x800000);
+        break;
+      case TABLE_FRAME_FLOAT:
+        writer.real(cell, color, next(state) / 1000.0f, next(state) % 4);
+        break;
+      }
+    }
+    auto size = writer.end();
+
+    if (noise > 0 && next(state) % noise == 0) {
+      switch (next(state) % 4) {
+      case 0:
+        buffer[next(state) % size] ^= 1 << next(state) % 8;
+        break;
+      case 1:
+        size = 0;
+        break;
+      case 2:
+        fwrite(buffer, 1, size, file);
+        break;
+      case 3:
+        size = next(state) % size;
+        break;
+      }
+    }
+    fwrite(buffer, 1, size, file);
+  }
+
+  fclose(file);
+  return 0;
+}
+
+static int play(const char *path, size_t chunk) {
+  FILE *file = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+  if (file == nullptr) {
+    perror(path);
+    return 1;
+  }
+
+  std::vector<uint8_t> bytes;
+  uint8_t read[4096];
+  for (size_t count; (count = fread(read, 1, sizeof(read), file)) > 0;)
+    bytes.insert(bytes.end(), read, read + count);
+  if (file != stdin)
+    fclose(file);
+
+  TFT_eSPI tft;
+  TableHeap table(&tft, 0, 0, 480, 320, rows, columns, TFT_WHITE, TFT_BLACK);
+  table.generate();
+  table.draw();
+  TableFrameDecoder<TableHeap> decoder(&table);
+  tft.reset();
+
+  //a receive buffer as in the README, large enough for the longest frame
+  std::vector<uint8_t> buffer(TABLE_FRAME_HEADER_SIZE + TABLE_FRAME_MAX_PAYLOAD + 1 + chunk);
+  size_t used = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (size_t position = 0; position < bytes.size();) {
+    auto count = std::min(chunk, std::min(bytes.size() - position, buffer.size() - used));
+    memcpy(buffer.data() + used, bytes.data() + position, count);
+    position += count;
+    used += count;
+
+    size_t consumed = decoder.decode(buffer.data(), used);
+    memmove(buffer.data(), buffer.data() + consumed, used - consumed);
+    used -= consumed;
+  }
+  std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+  printf("bytes    %10zu\n", bytes.size());
+  printf("frames   %10u\n", decoder.getFrames());
+  printf("updates  %10u\n", decoder.getUpdates());
+  printf("stale    %10u\n", decoder.getStale());
+  printf("lost     %10u\n", decoder.getLost());
+  printf("errors   %10u\n", decoder.getErrors());
+  printf("left     %10zu\n", used);
+  printf("pixels   %10u\n", tft.counters.pixels);
+  printf("windows  %10u\n", tft.counters.windows);
+  printf("updates/s %9.0f (CPU side only, no bus)\n", decoder.getUpdates() / seconds.count());
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc >= 3 && strcmp(argv[1], "record") == 0)
+    return record(argv[2], argc > 3 ? atoi(argv[3]) : 10000, argc > 4 ? atoi(argv[4]) : 0);
+  if (argc >= 3 && strcmp(argv[1], "play") == 0)
+    return play(argv[2], argc > 3 && atoi(argv[3]) > 0 ? atoi(argv[3]) : 64);
+
+  fprintf(stderr, "usage: %s record FILE [FRAMES] [NOISE]\n       %s play FILE|- [CHUNK]\n", argv[0], argv[0]);
+  return 2;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+//minimal checks for the host tests: CHECK() reports the failing line and carries on, each test
+//program returns testResult() from main()
+
+#include <stdio.h>
+
+inline int &testFailures() {
+  static int failures = 0;
+  return failures;
+}
+
+#define CHECK(condition) \
+  do { \
+    if (!(condition)) { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+      testFailures()++; \
+    } \
+  } while (0)
+
+inline int testResult(const char *name) {
+  printf("%s: %s\n", name, testFailures() == 0 ? "ok" : "FAILED");
+  return testFailures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+//TableFrameDecoder against frames that are corrupt, missing, repeated or cut short
+
+#include <vector>
+
+#include "TableFrames.h"
+#include "TableHeap.h"
+
+#include "test.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+//a frame setting the fill of a cell to color and its text to the sequence number
+static Bytes frame(uint16_t sequence, uint16_t cell, uint16_t color) {
+  uint8_t buffer[64];
+  TableFrameWriter writer(buffer, sizeof(buffer));
+  writer.begin(sequence);
+  writer.fill(cell, color);
+  writer.integer(cell, TFT_WHITE, sequence);
+  return Bytes(buffer, buffer + writer.end());
+}
+
+static Bytes join(std::initializer_list<Bytes> frames) {
+  Bytes bytes;
+  for (auto &frame : frames)
+    bytes.insert(bytes.end(), frame.begin(), frame.end());
+  return bytes;
+}
+
+struct Receiver {
+  TFT_eSPI tft;
+  TableHeap table;
+  TableFrameDecoder<TableHeap, 4> decoder;
+
+  Receiver() : table(&tft, 0, 0, 480, 320, 4, 4, TFT_WHITE, TFT_BLACK), decoder(&table) {
+    table.generate();
+    table.draw();
+  }
+
+  size_t decode(const Bytes &bytes) { return decoder.decode(bytes.data(), bytes.size()); }
+  bool shows(uint16_t cell, uint16_t color, const char *text) {
+    return table.getCellFillColor(cell / 4, cell % 4) == color && strcmp(table.getCellText(cell / 4, cell % 4), text) == 0;
+  }
+};
+
+static void checkValid() {
+  Receiver receiver;
+  auto bytes = join({frame(1, 0, TFT_RED), frame(2, 5, TFT_BLUE), frame(3, 15, TFT_GREEN)});
+  receiver.tft.reset();
+  CHECK(receiver.decode(bytes) == bytes.size());
+  //each restyled cell is drawn once, with its new text
+  CHECK(receiver.tft.counters.strings == 3);
+  CHECK(receiver.decoder.getFrames() == 3);
+  CHECK(receiver.decoder.getUpdates() == 6);
+  CHECK(receiver.decoder.getErrors() == 0);
+  CHECK(receiver.shows(0, TFT_RED, "1") && receiver.shows(5, TFT_BLUE, "2") && receiver.shows(15, TFT_GREEN, "3"));
+  CHECK(!receiver.table.hasDirtyCells());
+
+  //more texts in a frame than the decoder batches at once
+  uint8_t buffer[256];
+  TableFrameWriter writer(buffer, sizeof(buffer));
+  writer.begin(4);
+  for (uint16_t cell = 0; cell < 16; cell++)
+    writer.text(cell, TFT_WHITE, "x");
+  receiver.decoder.decode(buffer, writer.end());
+  CHECK(receiver.decoder.getUpdates() == 22);
+  CHECK(receiver.shows(15, TFT_GREEN, "x"));
+}
+
+//a bad checksum drops the frame, the decoder resyncs on the next one
+static void checkChecksum() {
+  Receiver receiver;
+  auto bad = frame(1, 0, TFT_RED);
+  bad.back() ^= 0x01;
+  auto flipped = frame(2, 1, TFT_RED);
+  flipped[TABLE_FRAME_HEADER_SIZE + 3] ^= 0x10;
+
+  auto bytes = join({bad, flipped, frame(3, 2, TFT_BLUE)});
+  CHECK(receiver.decode(bytes) == bytes.size());
+  CHECK(receiver.decoder.getErrors() == 2);
+  CHECK(receiver.decoder.getFrames() == 1);
+  CHECK(receiver.shows(0, TFT_BLACK, "") && receiver.shows(1, TFT_BLACK, ""));
+  CHECK(receiver.shows(2, TFT_BLUE, "3"));
+
+  //a length past the limit is noise too
+  Bytes noise = {TABLE_FRAME_SYNC, 0xFF, 0xFF, 0, 0, 0};
+  auto next = join({noise, frame(4, 3, TFT_GREEN)});
+  CHECK(receiver.decode(next) == next.size());
+  CHECK(receiver.decoder.getErrors() == 3);
+  CHECK(receiver.shows(3, TFT_GREEN, "4"));
+}
+
+//gaps in the sequence numbers count as lost frames, old and repeated frames are dropped
+static void checkSequence() {
+  Receiver receiver;
+  receiver.decode(join({frame(10, 0, TFT_RED), frame(11, 0, TFT_RED), frame(15, 1, TFT_RED)}));
+  CHECK(receiver.decoder.getFrames() == 3);
+  CHECK(receiver.decoder.getLost() == 3);
+
+  receiver.decode(join({frame(15, 2, TFT_RED), frame(12, 3, TFT_RED)}));
+  CHECK(receiver.decoder.getStale() == 2);
+  CHECK(receiver.shows(2, TFT_BLACK, "") && receiver.shows(3, TFT_BLACK, ""));
+
+  //after reset() any number starts over
+  receiver.decoder.reset();
+  receiver.decode(frame(3, 6, TFT_BLUE));
+  CHECK(receiver.shows(6, TFT_BLUE, "3"));
+  CHECK(receiver.decoder.getStale() == 2);
+
+  //numbers wrap around, anything up to half the range ahead is newer
+  Receiver wrapped;
+  wrapped.decode(join({frame(65534, 0, TFT_RED), frame(65535, 1, TFT_RED), frame(0, 2, TFT_RED), frame(2, 3, TFT_RED)}));
+  CHECK(wrapped.decoder.getFrames() == 4);
+  CHECK(wrapped.decoder.getLost() == 1);
+  CHECK(wrapped.decoder.getStale() == 0);
+  CHECK(wrapped.shows(3, TFT_RED, "2"));
+}
+
+static void checkTruncated() {
+  Receiver receiver;
+  auto first = frame(1, 0, TFT_RED);
+  auto second = frame(2, 1, TFT_BLUE);
+  auto bytes = join({first, second});
+
+  //the rest of a frame arrives later: what is there is kept and the frame is applied once complete,
+  //whatever the split
+  for (size_t split = 1; split < second.size(); split++) {
+    Receiver chunked;
+    Bytes head(bytes.begin(), bytes.begin() + first.size() + split);
+    CHECK(chunked.decode(head) == first.size());
+    CHECK(chunked.decoder.getFrames() == 1);
+
+    Bytes rest(bytes.begin() + first.size(), bytes.end());
+    CHECK(chunked.decode(rest) == rest.size());
+    CHECK(chunked.decoder.getFrames() == 2 && chunked.decoder.getErrors() == 0);
+    CHECK(chunked.shows(1, TFT_BLUE, "2"));
+  }
+
+  //a frame cut short by the sender fails its checksum once enough bytes follow, the frames after it
+  //are still applied
+  Bytes cut(first.begin(), first.end() - 4);
+  auto stream = join({cut, second, frame(3, 2, TFT_GREEN)});
+  CHECK(receiver.decode(stream) == stream.size());
+  CHECK(receiver.decoder.getErrors() == 1);
+  CHECK(receiver.decoder.getFrames() == 2);
+  CHECK(receiver.shows(0, TFT_BLACK, ""));
+  CHECK(receiver.shows(1, TFT_BLUE, "2") && receiver.shows(2, TFT_GREEN, "3"));
+
+  //records cut inside a valid frame stop at the last whole one
+  uint8_t buffer[64];
+  TableFrameWriter writer(buffer, sizeof(buffer));
+  writer.begin(4);
+  writer.fill(3, TFT_RED);
+  writer.text(4, TFT_WHITE, "abc");
+  auto size = writer.end();
+  //drop the text's terminator and patch length and checksum
+  buffer[1]--;
+  uint8_t checksum = 0;
+  for (size_t i = 3; i < size - 2; i++)
+    checksum += buffer[i];
+  buffer[size - 2] = checksum;
+  receiver.decoder.decode(buffer, size - 1);
+  CHECK(receiver.decoder.getFrames() == 3);
+  CHECK(receiver.decoder.getErrors() == 2);
+  CHECK(receiver.table.getCellFillColor(0, 3) == TFT_RED);
+  CHECK(strcmp(receiver.table.getCellText(1, 0), "") == 0);
+}
+
+int main() {
+  checkValid();
+  checkChecksum();
+  checkSequence();
+  checkTruncated();
+
+  return testResult("frames");
+}
@@ -0,0 +1,140 @@
+//TableRenderQueue and TableRenderTask with the producer and the consumer on two std::threads
+
+#include <thread>
+
+#include "TableHeap.h"
+#include "TableRenderTask.h"
+
+#include "test.h"
+
+static const uint32_t count = 1000000;
+
+//a sequence number spread over every field, and into the text every 16th command, so a torn or
+//reordered copy shows
+static TableCellCommand numbered(uint32_t sequence) {
+  TableCellCommand command;
+  command.type = sequence % 3;
+  command.row = sequence >> 16;
+  command.column = sequence >> 24;
+  command.color = sequence;
+  if (sequence % 16 == 0)
+    snprintf(command.text, sizeof(command.text), "%u", sequence);
+  else
+    command.text[0] = '\0';
+  return command;
+}
+
+template <uint16_t Capacity>
+static void checkOrder() {
+  static TableRenderQueue<Capacity> queue;
+
+  std::thread producer([] {
+    for (uint32_t sequence = 0; sequence < count; sequence++) {
+      auto command = numbered(sequence);
+      while (!queue.push(command))
+        std::this_thread::yield();
+    }
+  });
+
+  uint32_t received = 0;
+  uint32_t wrong = 0;
+  TableCellCommand command;
+  while (received < count) {
+    if (!queue.pop(command)) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    auto expected = numbered(received);
+    if (command.type != expected.type || command.row != expected.row || command.column != expected.column
+        || command.color != expected.color || strcmp(command.text, expected.text) != 0)
+      wrong++;
+    received++;
+  }
+  producer.join();
+
+  CHECK(wrong == 0);
+  CHECK(!queue.pop(command));
+}
+
+static void checkCoalesce() {
+  TableCellCommand commands[] = {
+    {TABLE_COMMAND_TEXT, 1, 0, 1, "a"},
+    {TABLE_COMMAND_FILL, 1, 0, 2, ""},
+    {TABLE_COMMAND_FILL, 0, 2, 3, ""},
+    {TABLE_COMMAND_TEXT, 1, 0, 4, "b"},
+    {TABLE_COMMAND_FILL, 1, 0, 5, ""},
+    {TABLE_COMMAND_OUTLINE, 0, 2, 6, ""},
+  };
+  auto kept = tableCoalesceCommands(commands, 6);
+
+  CHECK(kept == 4);
+  CHECK(commands[0].row == 0 && commands[0].type == TABLE_COMMAND_FILL && commands[0].color == 3);
+  CHECK(commands[1].row == 0 && commands[1].type == TABLE_COMMAND_OUTLINE && commands[1].color == 6);
+  CHECK(commands[2].row == 1 && commands[2].type == TABLE_COMMAND_FILL && commands[2].color == 5);
+  CHECK(commands[3].row == 1 && commands[3].type == TABLE_COMMAND_TEXT && strcmp(commands[3].text, "b") == 0);
+}
+
+//the application thread rewrites every cell many times while render() runs on another, once both are
+//done the table holds the last value of each cell and the screen shows it
+static void checkTask() {
+  TFT_eSPI tft;
+  TableHeap table(&tft, 0, 0, 480, 320, 8, 8, TFT_WHITE, TFT_BLACK);
+  table.generate();
+  table.draw();
+
+  TableRenderTask<TableHeap> task(&table);
+  std::atomic<bool> done(false);
+
+  std::thread producer([&] {
+    char text[TABLE_CELL_TEXT_SIZE];
+    for (uint16_t round = 1; round <= 200; round++) {
+      for (uint8_t row = 0; row < 8; row++) {
+        for (uint8_t column = 0; column < 8; column++) {
+          snprintf(text, sizeof(text), "%u", round * 100 + row * 8 + column);
+          while (!task.setCellFillColor(row, column, round))
+            std::this_thread::yield();
+          while (!task.setCellOutlineColor(row, column, round + 1000))
+            std::this_thread::yield();
+          while (!task.updateCellText(row, column, text, TFT_WHITE))
+            std::this_thread::yield();
+        }
+      }
+    }
+    done = true;
+  });
+
+  while (!done)
+    task.render();
+  producer.join();
+  while (task.render() > 0) {
+  }
+
+  uint32_t wrong = 0;
+  char text[TABLE_CELL_TEXT_SIZE];
+  for (uint8_t row = 0; row < 8; row++) {
+    for (uint8_t column = 0; column < 8; column++) {
+      snprintf(text, sizeof(text), "%u", 200 * 100 + row * 8 + column);
+      if (table.getCellFillColor(row, column) != 200 || table.getCellOutlineColor(row, column) != 1200
+          || strcmp(table.getCellText(row, column), text) != 0)
+        wrong++;
+    }
+  }
+  CHECK(wrong == 0);
+  CHECK(!table.hasDirtyCells());
+
+  auto rendered = tft.frame;
+  tft.fill(0);
+  table.draw();
+  CHECK(tft.frame == rendered);
+}
+
+int main() {
+  checkOrder<1>();
+  checkOrder<64>();
+  checkOrder<1024>();
+  checkCoalesce();
+  checkTask();
+
+  return testResult("queue");
+}
@@ -0,0 +1,431 @@
+//every draw path against a reference picture: each cell erased and outlined on its own with
+//eraseCell() and drawCellOutline(), the way the first versions drew one fillRect() and one drawRect()
+//per cell
+
+#include <vector>
+
+#include "TableFlash.h"
+#include "TableHeap.h"
+#include "TableStack.h"
+
+#include "test.h"
+
+static const uint16_t background = 0x1234;
+
+static uint16_t fillOf(uint8_t row, uint8_t column, uint8_t variant) {
+  static const uint16_t colors[] = {TFT_BLACK, TFT_BLUE, TFT_RED, TFT_GREEN, 0x7BEF};
+  return colors[(row * 7 + column * 3 + variant) % 5];
+}
+
+//every fourth cell solid, the others share outline colors over runs of rows and columns
+static uint16_t outlineOf(uint8_t row, uint8_t column, uint8_t variant) {
+  static const uint16_t colors[] = {TFT_WHITE, TFT_YELLOW, 0x8410};
+  if ((row + column + variant) % 4 == 0)
+    return fillOf(row, column, variant);
+  return colors[(row / 2 + column / 3 + variant) % 3];
+}
+
+template <class Table>
+static void paint(Table &table, uint8_t variant, uint8_t everyNth = 1) {
+  for (uint8_t row = 0; row < table.getRows(); row++) {
+    for (uint8_t column = 0; column < table.getColumns(); column++) {
+      if ((row * table.getColumns() + column) % everyNth != 0)
+        continue;
+      table.setCellFillColor(row, column, fillOf(row, column, variant));
+      table.setCellOutlineColor(row, column, outlineOf(row, column, variant));
+    }
+  }
+}
+
+//drawn over the background and returned, the screen is left as it was
+template <class Table>
+static std::vector<uint16_t> reference(TFT_eSPI &tft, Table &table) {
+  auto screen = tft.frame;
+  tft.fill(background);
+  for (uint8_t row = 0; row < table.getRows(); row++) {
+    for (uint8_t column = 0; column < table.getColumns(); column++) {
+      table.eraseCell(row, column);
+      table.drawCellOutline(row, column);
+    }
+  }
+
+  auto frame = tft.frame;
+  tft.frame = screen;
+  return frame;
+}
+
+//draw(), drawScanlines() and flush() on a generated table
+template <class Table>
+static void checkPaths(TFT_eSPI &tft, Table &table) {
+  paint(table, 0);
+  auto initial = reference(tft, table);
+
+  tft.fill(background);
+  table.draw();
+  CHECK(tft.frame == initial);
+
+  //the first cell starts at getX(), getY()
+  CHECK(tft.pixel(table.getX(), table.getY()) == outlineOf(0, 0, 0));
+  CHECK(tft.pixel(table.getX() - 1, table.getY()) == background);
+  CHECK(tft.pixel(table.getX(), table.getY() - 1) == background);
+
+  tft.fill(background);
+  table.drawScanlines();
+  CHECK(tft.frame == initial);
+
+  //every third cell recolored
+  paint(table, 1, 3);
+  auto changed = reference(tft, table);
+  table.flush();
+  CHECK(tft.frame == changed);
+
+  //nothing left to repaint
+  tft.reset();
+  table.flush();
+  CHECK(tft.counters.pixels == 0);
+}
+
+//the same recolor through step() with a small pixel budget, then beginDraw() repainting everything
+template <class Table>
+static void checkSteps(TFT_eSPI &tft, Table &table) {
+  paint(table, 0);
+  tft.fill(background);
+  table.draw();
+
+  paint(table, 1, 3);
+  auto changed = reference(tft, table);
+  while (table.step(0, 500)) {
+  }
+  CHECK(tft.frame == changed);
+  CHECK(!table.hasDirtyCells());
+
+  tft.fill(background);
+  table.beginDraw();
+  CHECK(table.hasDirtyCells());
+  while (table.step(200)) {
+  }
+  CHECK(tft.frame == changed);
+}
+
+//the same recolor composed in sprites: ones that fit, small ones and ones that can't be allocated
+template <class Table>
+static void checkSprite(TFT_eSPI &tft, Table &table) {
+  for (uint32_t maxBytes : {1u << 20, 2048u, 0u}) {
+    paint(table, 0);
+    tft.fill(background);
+    table.draw();
+
+    paint(table, 1, 3);
+    auto changed = reference(tft, table);
+    TFT_eSprite sprite(&tft);
+    TFT_eSprite::maxBytes() = maxBytes;
+    table.flushSprite(&sprite, 4096);
+    TFT_eSprite::maxBytes() = 0xFFFFFFFF;
+    CHECK(tft.frame == changed);
+  }
+}
+
+//a dirty row wider than maxBytes is pushed in groups of columns, a cell too large on its own directly
+static void checkWideSprite() {
+  TFT_eSPI tft;
+  TableHeap table(&tft, 0, 0, 480, 40, 1, 8, TFT_WHITE, TFT_BLACK);
+  table.generate();
+  paint(table, 1);
+  auto expected = reference(tft, table);
+
+  //cells are 60x40, 4800 bytes each: {maxBytes, sprites pushed}, 0 pushes means drawn directly
+  const uint32_t cases[][2] = {{1u << 20, 1}, {10000, 4}, {4800, 8}, {4000, 0}};
+  for (auto &limits : cases) {
+    tft.fill(background);
+    table.beginDraw();
+    tft.reset();
+    TFT_eSprite sprite(&tft);
+    table.flushSprite(&sprite, limits[0]);
+    CHECK(tft.frame == expected);
+    CHECK(!table.hasDirtyCells());
+    if (limits[1] > 0)
+      CHECK(tft.counters.windows == limits[1] && tft.counters.calls == limits[1]);
+    else
+      CHECK(tft.counters.calls == 8 * 5);
+  }
+}
+
+static void checkHeap(uint8_t rows, uint8_t columns, uint8_t paletteBits) {
+  TFT_eSPI tft;
+  TableHeap table(&tft, 7, 5, 460, 300, rows, columns, TFT_WHITE, TFT_BLACK, paletteBits);
+  table.setPaddingLeft(3);
+  table.setPaddingTop(2);
+  table.setPaddingRight(4);
+  table.setPaddingBottom(1);
+  if (columns > 2)
+    table.setColumnWidth(1, 40);
+  if (rows > 1)
+    table.setRowHeight(0, 30);
+  table.generate();
+  checkPaths(tft, table);
+  checkSteps(tft, table);
+  checkSprite(tft, table);
+}
+
+template <uint8_t PaletteBits>
+static void checkStack() {
+  TFT_eSPI tft;
+  TableStack<7, 5, 460, 300, 6, 9, PaletteBits> table(&tft, TFT_WHITE, TFT_BLACK);
+  table.setPaddingLeft(3);
+  table.setPaddingTop(2);
+  table.setColumnWidth(1, 40);
+  table.setRowHeight(0, 30);
+  table.generate();
+  checkPaths(tft, table);
+  checkSteps(tft, table);
+  checkSprite(tft, table);
+}
+
+static void checkFlash() {
+  TFT_eSPI tft;
+  TableFlash<7, 5, 460, 300, TableSizes<0, 40, 0, 0, 13, 0>, TableSizes<30, 0, 0, 0>, 2, 1, 3, 4> table(&tft, TFT_WHITE, TFT_BLACK);
+  checkPaths(tft, table);
+  checkSteps(tft, table);
+  checkSprite(tft, table);
+}
+
+//geometry changes repaint exactly the cells that moved
+template <class Table>
+static void relayout(TFT_eSPI &tft, Table &table) {
+  table.generate();
+  paint(table, 0);
+  tft.fill(background);
+  table.draw();
+
+  table.setColumnWidth(3, 90);
+  table.setRowHeight(2, 20);
+  auto damage = table.relayout();
+  CHECK(damage.width > 0 && damage.height > 0);
+  table.flush();
+  CHECK(tft.frame == reference(tft, table));
+  CHECK(table.relayout().width == 0);
+}
+
+static void checkRelayout() {
+  TFT_eSPI tft;
+  TableHeap heap(&tft, 0, 0, 480, 320, 4, 6, TFT_WHITE, TFT_BLACK);
+  relayout(tft, heap);
+
+  TableStack<0, 0, 480, 320, 4, 6> stack(&tft, TFT_WHITE, TFT_BLACK);
+  relayout(tft, stack);
+}
+
+//updateCellText() and updateCells() leave every cell as if it had been erased and only its last text
+//drawn on it, through recolors and redraws; twin is laid out like table and draws that picture
+template <class Table>
+static void texts(TFT_eSPI &tft, Table &table, Table &twin, bool batched, TableGlyphCache *glyphs = nullptr) {
+  static char texts[5][4][TABLE_CELL_TEXT_SIZE];
+  static uint16_t colors[5][4];
+  memset(texts, 0, sizeof(texts));
+
+  table.setGlyphCache(glyphs);
+  table.generate();
+  twin.generate();
+  paint(table, 0);
+  paint(twin, 0);
+  tft.fill(background);
+  table.draw();
+  uint32_t strings = 0;
+
+  for (int step = 0; step < 40; step++) {
+    TableCellUpdate updates[4];
+    for (uint8_t i = 0; i < 4; i++) {
+      uint8_t row = (step + i) % 5;
+      uint8_t column = (step * 3 + i) % 4;
+      snprintf(texts[row][column], TABLE_CELL_TEXT_SIZE, "%d", step * (i % 2 == 0 ? 1 : -7) * 13);
+      colors[row][column] = i % 2 == 0 ? TFT_WHITE : TFT_YELLOW;
+      updates[i] = {row, column, texts[row][column], colors[row][column]};
+      if (!batched)
+        table.updateCellText(row, column, texts[row][column], colors[row][column]);
+    }
+    if (batched) {
+      strings += tft.counters.strings;
+      tft.reset();
+      table.updateCells(updates, 4);
+      CHECK(tft.counters.transactions == 1);
+    }
+    if (step % 10 == 9) {
+      paint(table, step % 3, 5);
+      paint(twin, step % 3, 5);
+      table.flush();
+    }
+  }
+
+  //every text fits the cache, so none is drawn with drawString()
+  strings += tft.counters.strings;
+  if (glyphs != nullptr)
+    CHECK(strings == 0);
+
+  auto screen = tft.frame;
+  tft.frame = reference(tft, twin);
+  for (uint8_t row = 0; row < 5; row++) {
+    for (uint8_t column = 0; column < 4; column++) {
+      CHECK(strcmp(table.getCellText(row, column), texts[row][column]) == 0);
+      if (texts[row][column][0] != '\0')
+        twin.drawCellText(row, column, texts[row][column], colors[row][column]);
+    }
+  }
+  auto expected = tft.frame;
+  CHECK(screen == expected);
+
+  //draw() and drawScanlines() bring the texts back
+  tft.fill(background);
+  table.draw();
+  CHECK(tft.frame == expected);
+  tft.fill(background);
+  table.drawScanlines();
+  CHECK(tft.frame == expected);
+
+  table.eraseCell(2, 0);
+  CHECK(strcmp(table.getCellText(2, 0), "") == 0);
+}
+
+static void checkTexts() {
+  TFT_eSPI tft;
+  tft.setTextSize(2);
+
+  for (bool batched : {false, true}) {
+    TableHeap heap(&tft, 0, 0, 480, 320, 5, 4, TFT_WHITE, TFT_BLACK);
+    TableHeap heapTwin(&tft, 0, 0, 480, 320, 5, 4, TFT_WHITE, TFT_BLACK);
+    texts(tft, heap, heapTwin, batched);
+
+    TableStack<0, 0, 480, 320, 5, 4, 4, true> stack(&tft, TFT_WHITE, TFT_BLACK);
+    TableStack<0, 0, 480, 320, 5, 4, 4, true> stackTwin(&tft, TFT_WHITE, TFT_BLACK);
+    texts(tft, stack, stackTwin, batched);
+
+    TableGlyphCache glyphs(&tft);
+    TableHeap cached(&tft, 0, 0, 480, 320, 5, 4, TFT_WHITE, TFT_BLACK);
+    tft.reset();
+    texts(tft, cached, heapTwin, batched, &glyphs);
+    TableStack<0, 0, 480, 320, 5, 4, 4, true> stackCached(&tft, TFT_WHITE, TFT_BLACK);
+    tft.reset();
+    texts(tft, stackCached, stackTwin, batched, &glyphs);
+  }
+  //the last update of a cell wins, wherever it is in the batch
+  TableHeap table(&tft, 0, 0, 480, 320, 3, 3, TFT_WHITE, TFT_BLACK);
+  table.generate();
+  table.draw();
+  TableCellUpdate updates[] = {{1, 1, "first", TFT_WHITE}, {2, 0, "x", TFT_WHITE}, {1, 1, "last", TFT_YELLOW}};
+  table.updateCells(updates, 3);
+  CHECK(strcmp(table.getCellText(1, 1), "last") == 0);
+  CHECK(strcmp(table.getCellText(2, 0), "x") == 0);
+
+  //the glyph cache declines smooth and free fonts, their texts go through drawString()
+  static const GFXfont freeFont = {nullptr};
+  TableGlyphCache declined(&tft);
+  table.setGlyphCache(&declined);
+  for (bool smooth : {true, false}) {
+    tft.fontLoaded = smooth;
+    tft.setFreeFont(smooth ? nullptr : &freeFont);
+    tft.reset();
+    table.updateCellText(0, 0, smooth ? "12" : "34", TFT_WHITE);
+    CHECK(tft.counters.strings == 1);
+    CHECK(declined.getBytes() == 0);
+  }
+  tft.setTextFont(1);
+}
+
+//cellAt() names the cell that painted a pixel: every cell is solid in a color of its own index
+template <class Table>
+static void hits(TFT_eSPI &tft, Table &table) {
+  for (uint8_t row = 0; row < table.getRows(); row++) {
+    for (uint8_t column = 0; column < table.getColumns(); column++) {
+      table.setCellFillColor(row, column, row * table.getColumns() + column);
+      table.setCellOutlineColor(row, column, row * table.getColumns() + column);
+    }
+  }
+  tft.fill(TABLE_NO_CELL);
+  table.draw();
+
+  for (uint16_t y = 0; y < tft.height(); y++) {
+    uint16_t xs[8];
+    uint16_t ys[8];
+    uint16_t cells[8];
+    for (uint16_t x = 0; x < tft.width(); x++) {
+      CHECK(table.cellAt(x, y) == tft.pixel(x, y));
+      xs[x % 8] = x;
+      ys[x % 8] = y;
+      if (x % 8 == 7) {
+        table.cellsAt(xs, ys, cells, 8);
+        for (uint8_t i = 0; i < 8; i++)
+          CHECK(cells[i] == tft.pixel(xs[i], y));
+      }
+    }
+  }
+
+  uint8_t row, column;
+  CHECK(table.cellAt(table.getX(), table.getY(), row, column) && row == 0 && column == 0);
+  CHECK(!table.cellAt(table.getX() - 1, table.getY(), row, column));
+}
+
+static void checkHits() {
+  TFT_eSPI tft;
+  TableHeap heap(&tft, 7, 5, 460, 300, 17, 33, TFT_WHITE, TFT_BLACK);
+  heap.setPaddingLeft(3);
+  heap.setPaddingTop(2);
+  heap.setColumnWidth(1, 40);
+  heap.generate();
+  hits(tft, heap);
+
+  TableStack<7, 5, 460, 300, 6, 9> stack(&tft, TFT_WHITE, TFT_BLACK);
+  stack.setPaddingRight(5);
+  stack.setRowHeight(0, 30);
+  stack.generate();
+  hits(tft, stack);
+
+  TableFlash<7, 5, 460, 300, TableSizes<0, 40, 0, 0, 13, 0>, TableSizes<30, 0, 0, 0>, 2, 1, 3, 4> flash(&tft, TFT_WHITE, TFT_BLACK);
+  hits(tft, flash);
+}
+
+//the README's 3x9 inset layout: solid cells merge into rectangles, nothing is written twice
+static void checkInsets() {
+  TFT_eSPI tft;
+  TableHeap table(&tft, 0, 0, 480, 320, 3, 9, TFT_BLACK, TFT_BLACK);
+  table.setRowHeight(0, 8);
+  table.setRowHeight(2, 8);
+  for (uint8_t column = 0; column < 9; column += 2)
+    table.setColumnWidth(column, 8);
+  for (uint8_t column = 1; column < 9; column += 2)
+    table.setCellOutlineColor(1, column, TFT_WHITE);
+  table.generate();
+
+  auto expected = reference(tft, table);
+  tft.fill(background);
+  tft.reset();
+  table.draw();
+  CHECK(tft.frame == expected);
+  CHECK(tft.counters.pixels == (uint32_t)table.getWidth() * table.getHeight());
+
+  //the same layout given at compile time
+  TableFlash<0, 0, 480, 320, TableSizes<8, 0, 8, 0, 8, 0, 8, 0, 8>, TableSizes<8, 0, 8>> flash(&tft, TFT_BLACK, TFT_BLACK);
+  for (uint8_t column = 1; column < 9; column += 2)
+    flash.setCellOutlineColor(1, column, TFT_WHITE);
+  tft.fill(background);
+  flash.draw();
+  CHECK(tft.frame == expected);
+}
+
+int main() {
+  const uint8_t sizes[][2] = {{1, 1}, {2, 3}, {3, 9}, {8, 8}, {17, 33}, {64, 64}, {255, 255}};
+  for (auto &size : sizes) {
+    for (uint8_t paletteBits : {0, 4, 8})
+      checkHeap(size[0], size[1], paletteBits);
+  }
+
+  checkStack<0>();
+  checkStack<4>();
+  checkStack<8>();
+  checkFlash();
+  checkRelayout();
+  checkWideSprite();
+  checkInsets();
+  checkHits();
+  checkTexts();
+
+  return testResult("render");
+}
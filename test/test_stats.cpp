@@ -0,0 +1,61 @@
+//TABLE_STATS counters against what the recording stand-in received (this program is built with
+//-DTABLE_STATS)
+
+#include "TableHeap.h"
+#include "TableStack.h"
+
+#include "test.h"
+
+//one call charged to operation, with the pixels and address windows the panel saw
+template <class Table, class Op>
+static bool charged(TFT_eSPI &tft, Table &table, uint8_t operation, Op op) {
+  table.resetStats();
+  tft.reset();
+  op(table);
+
+  auto stats = table.getStats();
+  for (uint8_t i = 0; i < TABLE_STATS_OPERATIONS; i++) {
+    if (i != operation && stats.operations[i].calls != 0)
+      return false;
+  }
+  auto &counted = stats.operations[operation];
+  return counted.calls == 1 && counted.pixels == tft.counters.pixels && counted.transactions == tft.counters.windows;
+}
+
+template <class Table>
+static void checkCounts(TFT_eSPI &tft, Table &table) {
+  table.generate();
+  for (uint8_t row = 0; row < table.getRows(); row++) {
+    for (uint8_t column = 0; column < table.getColumns(); column += 2)
+      table.setCellOutlineColor(row, column, row % 3 == 0 ? TFT_BLACK : TFT_RED);
+  }
+
+  CHECK(charged(tft, table, TABLE_STATS_DRAW, [](Table &table) { table.draw(); }));
+  CHECK(charged(tft, table, TABLE_STATS_DRAW, [](Table &table) { table.drawScanlines(); }));
+  CHECK(charged(tft, table, TABLE_STATS_FLUSH, [](Table &table) {
+    table.setCellFillColor(1, 2, TFT_BLUE);
+    table.setCellFillColor(3, 0, TFT_BLUE);
+    table.flush();
+  }));
+  CHECK(charged(tft, table, TABLE_STATS_ERASE_CELL, [](Table &table) { table.eraseCell(2, 2); }));
+  CHECK(charged(tft, table, TABLE_STATS_CELL_OUTLINE, [](Table &table) { table.drawCellOutline(2, 2); }));
+
+  //nested calls are charged to the outermost one, text pixels are the text's box
+  table.resetStats();
+  table.drawCellText(0, 0, 1.5f, 1, TFT_WHITE);
+  auto text = table.getStats().operations[TABLE_STATS_CELL_TEXT];
+  CHECK(text.calls == 1);
+  CHECK(text.pixels == (uint32_t)tft.textWidth("1.5") * tft.fontHeight());
+}
+
+int main() {
+  TFT_eSPI tft;
+
+  TableHeap heap(&tft, 4, 3, 400, 300, 7, 5, TFT_WHITE, TFT_BLACK);
+  checkCounts(tft, heap);
+
+  TableStack<4, 3, 400, 300, 7, 5, 4> stack(&tft, TFT_WHITE, TFT_BLACK);
+  checkCounts(tft, stack);
+
+  return testResult("stats");
+}
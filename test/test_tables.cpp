@@ -0,0 +1,494 @@
+//palette indices, the text overloads, scrolling and series
+
+//runs the scroll register path of the controllers that have one
+#define TABLE_HARDWARE_SCROLL
+
+#include "TableArena.h"
+#include "TableFlash.h"
+#include "TableHeap.h"
+#include "TableRules.h"
+#include "TableScreen.h"
+#include "TableScroll.h"
+#include "TableSeries.h"
+#include "TableStack.h"
+
+#include "test.h"
+
+//rewriting a palette entry recolors and repaints exactly the cells using it
+template <class Table>
+static void checkTheme(TFT_eSPI &tft, Table &table) {
+  table.generate();
+  table.setPaletteColor(5, TFT_RED);
+  table.setCellFillIndex(1, 1, 5);
+  table.setCellOutlineIndex(2, 3, 5);
+  table.draw();
+
+  table.setPaletteColor(5, TFT_BLUE);
+  CHECK(table.getCellFillColor(1, 1) == TFT_BLUE);
+  CHECK(table.getCellOutlineColor(2, 3) == TFT_BLUE);
+  CHECK(table.getCellFillColor(2, 3) == TFT_BLACK);
+  CHECK(table.getPaletteColor(5) == TFT_BLUE);
+
+  //two 120x80 cells
+  tft.reset();
+  table.flush();
+  CHECK(tft.counters.pixels == 2 * 120 * 80);
+  CHECK(tft.pixel(180, 120) == TFT_BLUE);
+  CHECK(tft.pixel(360, 160) == TFT_BLUE);
+}
+
+//more colors than palette entries map to the closest entry
+static void checkClosest() {
+  TFT_eSPI tft;
+  TableHeap table(&tft, 0, 0, 480, 320, 4, 8, TFT_WHITE, TFT_BLACK, 4);
+  table.generate();
+  for (uint8_t column = 0; column < 8; column++) {
+    table.setCellFillColor(0, column, column << 11);
+    table.setCellFillColor(1, column, column);
+  }
+  for (uint8_t column = 0; column < 8; column++) {
+    CHECK(table.getCellFillColor(0, column) == column << 11);
+    CHECK(table.getCellFillColor(1, column) == column);
+  }
+
+  //all 16 entries taken, the red closest to 0x3900 is 0x3800
+  table.setCellFillColor(2, 0, 0x3900);
+  CHECK(table.getCellFillColor(2, 0) == 0x3800);
+}
+
+//indices outside the palette, and index calls on direct color tables, change nothing
+static void checkIndices() {
+  TFT_eSPI tft;
+
+  TableHeap heap(&tft, 0, 0, 480, 320, 4, 4, TFT_WHITE, TFT_BLACK, 4);
+  heap.generate();
+  heap.draw();
+  heap.setPaletteColor(200, TFT_RED);
+  heap.setCellFillIndex(0, 0, 16);
+  heap.setCellOutlineIndex(0, 0, 99);
+  CHECK(heap.getPaletteColor(200) == 0);
+  CHECK(heap.getCellFillColor(0, 0) == TFT_BLACK);
+  CHECK(heap.getCellOutlineColor(0, 0) == TFT_WHITE);
+  CHECK(!heap.hasDirtyCells());
+
+  heap.setPaletteColor(5, TFT_RED);
+  heap.setCellFillIndex(1, 1, 5);
+  CHECK(heap.getCellFillColor(1, 1) == TFT_RED);
+  CHECK(heap.hasDirtyCells());
+
+  TableHeap direct(&tft, 0, 0, 480, 320, 4, 4, TFT_WHITE, TFT_BLACK);
+  direct.generate();
+  direct.setCellFillIndex(0, 0, 5);
+  direct.setPaletteColor(7, TFT_RED);
+  CHECK(direct.getCellFillColor(0, 0) == TFT_BLACK);
+  CHECK(direct.getPaletteColor(7) == 0);
+
+  TableStack<0, 0, 480, 320, 4, 4, 4> stack(&tft, TFT_WHITE, TFT_BLACK);
+  stack.generate();
+  stack.draw();
+  stack.setPaletteColor(20, TFT_RED);
+  stack.setCellOutlineIndex(0, 0, 16);
+  CHECK(stack.getPaletteColor(20) == 0);
+  CHECK(stack.getCellOutlineColor(0, 0) == TFT_WHITE);
+  CHECK(!stack.hasDirtyCells());
+
+  TableStack<0, 0, 480, 320, 4, 4> stackDirect(&tft, TFT_WHITE, TFT_BLACK);
+  stackDirect.generate();
+  stackDirect.setCellFillIndex(0, 0, 5);
+  stackDirect.setPaletteColor(7, TFT_RED);
+  CHECK(stackDirect.getCellFillColor(0, 0) == TFT_BLACK);
+
+  //unsupported widths leave the table empty instead of mis-sizing its colors
+  for (uint8_t paletteBits : {2, 16}) {
+    TableHeap odd(&tft, 0, 0, 480, 320, 4, 4, TFT_WHITE, TFT_BLACK, paletteBits);
+    CHECK(!odd.isValid());
+    CHECK(odd.getRows() == 0 && odd.getColumns() == 0);
+    CHECK(TableHeap::requiredBytes(4, 4, paletteBits) == 0);
+    odd.generate();
+    odd.setPaletteColor(3, TFT_RED);
+    odd.setCellFillIndex(0, 0, 3);
+    odd.setCellFillColor(1, 1, TFT_RED);
+    tft.reset();
+    odd.draw();
+    odd.flush();
+    CHECK(tft.counters.pixels == 0);
+    CHECK(!odd.hasDirtyCells());
+  }
+}
+
+static void checkPalette() {
+  TFT_eSPI tft;
+
+  TableHeap heap4(&tft, 0, 0, 480, 320, 4, 4, TFT_WHITE, TFT_BLACK, 4);
+  checkTheme(tft, heap4);
+  TableHeap heap8(&tft, 0, 0, 480, 320, 4, 4, TFT_WHITE, TFT_BLACK, 8);
+  checkTheme(tft, heap8);
+  TableStack<0, 0, 480, 320, 4, 4, 4> stack4(&tft, TFT_WHITE, TFT_BLACK);
+  checkTheme(tft, stack4);
+  TableStack<0, 0, 480, 320, 4, 4, 8> stack8(&tft, TFT_WHITE, TFT_BLACK);
+  checkTheme(tft, stack8);
+
+  checkClosest();
+  checkIndices();
+}
+
+//tables in an arena draw like tables on the heap and take every buffer from it
+static void checkArena() {
+  TFT_eSPI tft;
+  static uint8_t buffer[16 * 1024];
+  TableArena arena(buffer, sizeof(buffer));
+
+  TableHeap heap(&tft, 0, 0, 480, 320, 8, 8, TFT_WHITE, TFT_BLACK, 4);
+  TableHeap table(&tft, 0, 0, 480, 320, 8, 8, TFT_WHITE, TFT_BLACK, 4, &arena);
+  CHECK(arena.getUsed() == TableHeap::requiredBytes(8, 8, 4));
+
+  for (auto t : {&heap, &table}) {
+    t->generate();
+    t->setCellFillColor(2, 3, TFT_RED);
+    t->updateCellText(4, 4, "42", TFT_WHITE);
+    tft.fill(0);
+    t->draw();
+    t->drawScanlines();
+  }
+  auto used = arena.getUsed();
+  CHECK(used >= TableHeap::requiredBytes(8, 8, 4) + 64 * sizeof(TableCellText) + 4 * 480);
+
+  tft.fill(0);
+  heap.draw();
+  auto expected = tft.frame;
+  tft.fill(0);
+  table.draw();
+  CHECK(tft.frame == expected);
+
+  //a wider scanline buffer comes from the arena too, nothing is given back before reset()
+  table.setColumnWidth(0, 600);
+  table.relayout();
+  table.drawScanlines();
+  CHECK(arena.getUsed() > used);
+
+  arena.rewind(used);
+  CHECK(arena.getUsed() == used);
+  arena.reset();
+  CHECK(arena.getUsed() == 0);
+  static uint8_t small[8];
+  TableArena tiny(small, sizeof(small));
+  CHECK(tiny.allocate(4) != nullptr);
+  CHECK(tiny.allocate(8) == nullptr);
+}
+
+//a table that doesn't fit its arena is empty and every call on it is harmless
+static void checkExhausted() {
+  TFT_eSPI tft;
+  static uint8_t small[64];
+  TableArena full(small, sizeof(small));
+
+  TableHeap empty(&tft, 0, 0, 480, 320, 8, 8, TFT_WHITE, TFT_BLACK, 4, &full);
+  CHECK(!empty.isValid());
+  CHECK(empty.getRows() == 0 && empty.getColumns() == 0);
+  empty.setColumnWidth(0, 10);
+  empty.generate();
+  tft.reset();
+  empty.draw();
+  empty.drawScanlines();
+  empty.beginDraw();
+  CHECK(!empty.step(0));
+  empty.updateCellText(0, 0, "1", TFT_WHITE);
+  empty.setPaletteColor(3, TFT_RED);
+  empty.flush();
+  CHECK(tft.counters.pixels == 0);
+  CHECK(empty.cellAt(10, 10) == TABLE_NO_CELL);
+  CHECK(!empty.hasDirtyCells());
+
+  //the block fits, texts and scanlines don't
+  static uint8_t exact[1024];
+  TableArena arena(exact, TableHeap::requiredBytes(8, 8) + 16);
+  TableHeap table(&tft, 0, 0, 480, 320, 8, 8, TFT_WHITE, TFT_BLACK, 0, &arena);
+  CHECK(table.isValid());
+  table.generate();
+  table.draw();
+  table.updateCellText(1, 1, "9", TFT_WHITE);
+  TableCellUpdate update = {0, 0, "1", TFT_WHITE};
+  table.updateCells(&update, 1);
+  CHECK(strcmp(table.getCellText(1, 1), "") == 0);
+  tft.reset();
+  table.drawScanlines();
+  CHECK(tft.counters.pixels == 0);
+
+  //without an arena nothing fails
+  TableHeap heap(&tft, 0, 0, 480, 320, 8, 8, TFT_WHITE, TFT_BLACK);
+  CHECK(heap.isValid());
+}
+
+//every overload prints the same text as the plain C string one
+template <class Table>
+static void checkOverloads(TFT_eSPI &tft, Table &table) {
+  auto same = [&](void (*draw)(Table &), const char *text) {
+    tft.fill(0);
+    table.drawCellText(1, 1, text, TFT_WHITE);
+    auto expected = tft.frame;
+    tft.fill(0);
+    draw(table);
+    return tft.frame == expected;
+  };
+
+  CHECK(same([](Table &table) { table.drawCellText(1, 1, 42, TFT_WHITE); }, "42"));
+  CHECK(same([](Table &table) { table.drawCellText(1, 1, (uint8_t)7, TFT_WHITE); }, "7"));
+  CHECK(same([](Table &table) { table.drawCellText(1, 1, -3L, TFT_WHITE); }, "-3"));
+  CHECK(same([](Table &table) { table.drawCellText(1, 1, 2.5f, 2, TFT_WHITE); }, "2.50"));
+  CHECK(same([](Table &table) { table.drawCellText(1, 1, "abcdef", (size_t)3, TFT_WHITE); }, "abc"));
+  CHECK(same([](Table &table) { table.drawCellText(1, 1, String("xy"), TFT_WHITE); }, "xy"));
+}
+
+static void checkText() {
+  TFT_eSPI tft;
+
+  TableHeap heap(&tft, 0, 0, 480, 320, 3, 3, TFT_WHITE, TFT_BLACK);
+  heap.generate();
+  checkOverloads(tft, heap);
+
+  TableStack<0, 0, 480, 320, 3, 3> stack(&tft, TFT_WHITE, TFT_BLACK);
+  stack.generate();
+  checkOverloads(tft, stack);
+  CHECK(strcmp(stack.getCellText(0, 0), "") == 0);
+
+  TableFlash<0, 0, 480, 320, TableSizes<0, 0, 0>, TableSizes<0, 0, 0>> flash(&tft, TFT_WHITE, TFT_BLACK);
+  checkOverloads(tft, flash);
+
+  //texts cost RAM only when asked for
+  CHECK(sizeof(TableStack<0, 0, 480, 320, 16, 16, 0, true>) - sizeof(TableStack<0, 0, 480, 320, 16, 16>)
+    == 255 * sizeof(TableCellText));
+}
+
+//"row.column"
+static const char *logCell(uint32_t row, uint8_t column, void *context) {
+  static char text[TABLE_CELL_TEXT_SIZE];
+  (void)context;
+  snprintf(text, sizeof(text), "%u.%u", (unsigned)row, column);
+  return text;
+}
+
+//rows first to first + rows - 1 are in their slots: from first on in place, r % rows in hardware mode
+template <class Table>
+static bool shows(TableScroll<Table> &scroll, Table &table, uint32_t first) {
+  for (auto row = first; row < first + table.getRows(); row++) {
+    uint8_t slot = scroll.isHardware() ? row % table.getRows() : row - first;
+    for (uint8_t column = 0; column < table.getColumns(); column++) {
+      if (strcmp(table.getCellText(slot, column), logCell(row, column, nullptr)) != 0)
+        return false;
+    }
+  }
+  return true;
+}
+
+static void checkScroll() {
+  TFT_eSPI tft;
+
+  //across the whole screen: the controller scrolls, a step repaints one row
+  TableHeap table(&tft, 0, 20, 480, 200, 5, 2, TFT_WHITE, TFT_BLACK);
+  table.generate();
+  TableScroll<TableHeap> scroll(&tft, &table, logCell, nullptr, 100, TFT_WHITE);
+  scroll.draw();
+  CHECK(scroll.isHardware());
+  CHECK(shows(scroll, table, 0));
+
+  tft.reset();
+  scroll.scrollBy(1);
+  CHECK(tft.counters.commands == 1);
+  CHECK(tft.counters.strings == 2);
+  CHECK(shows(scroll, table, 1));
+
+  scroll.scrollTo(1000);
+  CHECK(scroll.getFirstRow() == 95);
+  CHECK(shows(scroll, table, 95));
+  scroll.scrollBy(-200);
+  CHECK(scroll.getFirstRow() == 0);
+  CHECK(shows(scroll, table, 0));
+
+  //rows past the end show empty cells
+  scroll.setRowCount(3);
+  CHECK(strcmp(table.getCellText(3, 0), "") == 0);
+  CHECK(strcmp(table.getCellText(2, 1), "2.1") == 0);
+
+  scroll.end();
+  CHECK(!scroll.isHardware());
+
+  //narrower than the screen: the rows are rewritten in place
+  TableStack<10, 0, 300, 200, 4, 3, 0, true> stack(&tft, TFT_WHITE, TFT_BLACK);
+  stack.generate();
+  TableScroll<TableStack<10, 0, 300, 200, 4, 3, 0, true>> inPlace(&tft, &stack, logCell, nullptr, 50, TFT_WHITE);
+  inPlace.draw();
+  CHECK(!inPlace.isHardware());
+
+  tft.reset();
+  inPlace.scrollBy(2);
+  CHECK(tft.counters.commands == 0);
+  CHECK(shows(inPlace, stack, 2));
+}
+
+//the newest rows stay in view, an append repaints one row
+static void checkSeries() {
+  TFT_eSPI tft;
+  TableHeap table(&tft, 0, 0, 480, 160, 4, 3, TFT_WHITE, TFT_BLACK);
+  table.generate();
+  TableSeries<TableHeap, 8, 3> series(&tft, &table, TFT_WHITE);
+  series.draw();
+
+  for (int i = 0; i < 10; i++)
+    series.appendRow("row", i, i + 0.5f);
+  CHECK(series.getCount() == 10);
+  CHECK(series.getText(1, 0) == nullptr);
+  CHECK(strcmp(series.getText(2, 1), "2") == 0);
+  CHECK(strcmp(series.getText(9, 2), "9.50") == 0);
+  CHECK(strcmp(table.getCellText(9 % 4, 1), "9") == 0);
+
+  tft.reset();
+  series.setDecimals(0);
+  series.appendRow(String("last"), -1);
+  CHECK(tft.counters.commands == 1);
+  CHECK(tft.counters.strings == 3);
+  CHECK(strcmp(table.getCellText(10 % 4, 0), "last") == 0);
+  CHECK(strcmp(table.getCellText(10 % 4, 2), "") == 0);
+
+  series.clear();
+  CHECK(series.getCount() == 0);
+  CHECK(series.getText(10, 0) == nullptr);
+  series.end();
+}
+
+//a low priority table still gets a cell per frame while a higher one uses the whole budget
+static void checkStarvation() {
+  TFT_eSPI tft;
+  TableHeap background(&tft, 0, 100, 480, 220, 8, 8, TFT_WHITE, TFT_BLACK);
+  TableHeap alarm(&tft, 0, 0, 480, 100, 16, 16, TFT_WHITE, TFT_BLACK);
+  background.generate();
+  alarm.generate();
+
+  TableScreen<2> screen;
+  CHECK(screen.add(&background));
+  CHECK(screen.add(&alarm, 5));
+  CHECK(!screen.add(&alarm));
+
+  background.beginDraw();
+  int frames = 0;
+  while (background.hasDirtyCells() && frames < 1000) {
+    alarm.beginDraw();
+    screen.frame(1);
+    frames++;
+  }
+  CHECK(!background.hasDirtyCells());
+  CHECK(frames <= 64);
+
+  alarm.beginDraw();
+  while (screen.frame(0)) {
+  }
+  CHECK(!screen.hasDirtyCells());
+  CHECK(screen.remove(&alarm));
+  CHECK(!screen.remove(&alarm));
+  CHECK(screen.getCount() == 1);
+}
+
+//a whole screen repainted through frames, then single changed cells
+static void checkScreen() {
+  TFT_eSPI tft;
+  TableHeap background(&tft, 0, 100, 480, 220, 8, 8, TFT_WHITE, TFT_BLACK);
+  TableStack<0, 0, 480, 100, 4, 4> alarm(&tft, TFT_WHITE, TFT_BLACK);
+  background.generate();
+  alarm.generate();
+  background.setCellFillColor(3, 3, TFT_RED);
+  alarm.setCellFillColor(1, 1, TFT_RED);
+  tft.fill(0);
+  background.draw();
+  alarm.draw();
+  auto expected = tft.frame;
+
+  TableScreen<2> screen;
+  CHECK(screen.add(&background));
+  CHECK(screen.add(&alarm, 5));
+  CHECK(!screen.add(&alarm));
+  CHECK(!screen.add(&background, 1));
+  CHECK(screen.getCount() == 2);
+
+  tft.fill(0);
+  screen.beginDraw();
+  CHECK(screen.hasDirtyCells());
+  int frames = 0;
+  while (screen.frame(0) && frames < 1000)
+    frames++;
+  CHECK(!screen.hasDirtyCells());
+  CHECK(tft.frame == expected);
+
+  //one cell changed in each
+  background.setCellFillColor(0, 0, TFT_GREEN);
+  alarm.setCellFillColor(0, 0, TFT_GREEN);
+  CHECK(screen.hasDirtyCells());
+  while (screen.frame(0)) {
+  }
+  CHECK(!alarm.hasDirtyCells() && !background.hasDirtyCells());
+
+  CHECK(screen.setPriority(&background, 9));
+  CHECK(screen.remove(&alarm));
+  CHECK(!screen.remove(&alarm));
+  CHECK(!screen.setPriority(&alarm, 1));
+  CHECK(screen.getCount() == 1);
+}
+
+//values styled by band, repeated values draw nothing and the screen ends as a fresh draw() would paint it
+static void checkRules() {
+  static const TableBand bands[] = {
+    {40, {TFT_BLUE, TFT_WHITE, TFT_WHITE}},
+    {70, {TFT_YELLOW, TFT_WHITE, TFT_BLACK}},
+    {0, {TFT_RED, TFT_WHITE, TFT_WHITE}}
+  };
+  static const TableBand alarm[] = {{0, {TFT_RED, TFT_RED, TFT_BLACK}}};
+
+  TFT_eSPI tft;
+  TableHeap table(&tft, 0, 0, 480, 320, 4, 3, TFT_WHITE, TFT_BLACK);
+  table.generate();
+  tft.fill(0);
+  table.draw();
+
+  TableRules<TableHeap, 4, 3, 1> rules(&table, TFT_GREEN);
+  rules.setColumnBands(1, bands, 3, 1);
+  CHECK(rules.setCellBands(3, 1, alarm, 1, 0));
+  CHECK(!rules.setCellBands(0, 1, alarm, 1));
+  CHECK(rules.getBand(0, 1) == -1);
+
+  const float values[] = {12.5f, 55, 99, 20};
+  rules.setColumn(1, values, 4);
+  rules.setValue(2, 0, 7);
+  CHECK(rules.getBand(0, 1) == 0 && rules.getBand(1, 1) == 1 && rules.getBand(2, 1) == 2);
+  CHECK(rules.getBand(2, 0) == -1);
+  CHECK(table.getCellFillColor(1, 1) == TFT_YELLOW && table.getCellFillColor(3, 1) == TFT_RED);
+  CHECK(strcmp(table.getCellText(0, 1), "12.5") == 0 && strcmp(table.getCellText(3, 1), "20") == 0);
+  CHECK(strcmp(table.getCellText(2, 0), "7.00") == 0);
+
+  tft.reset();
+  rules.setColumn(1, values, 4);
+  CHECK(tft.counters.pixels == 0);
+
+  //one value moves up a band, another only changes its text; each cell is drawn once
+  const float next[] = {45, 56};
+  tft.reset();
+  rules.setColumn(1, next, 2);
+  CHECK(rules.getBand(0, 1) == 1 && rules.getBand(1, 1) == 1);
+  CHECK(tft.counters.strings == 2);
+  CHECK(!table.hasDirtyCells());
+  auto shown = tft.frame;
+  tft.fill(0);
+  table.draw();
+  CHECK(tft.frame == shown);
+}
+
+int main() {
+  checkPalette();
+  checkArena();
+  checkExhausted();
+  checkText();
+  checkScroll();
+  checkSeries();
+  checkScreen();
+  checkStarvation();
+  checkRules();
+
+  return testResult("tables");
+}